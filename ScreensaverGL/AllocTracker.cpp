@@ -0,0 +1,211 @@
+#include "AllocTracker.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "imgui.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#define ALLOC_NOINLINE	__declspec(noinline)
+#else
+#include <execinfo.h>
+#define ALLOC_NOINLINE	__attribute__((noinline))
+#endif
+
+AllocTracker Allocs;
+
+// Frames of the tracker itself on top of the stack: captureStack(), recordSite() and onAlloc()
+#define ALLOC_TRACKER_FRAMES	3
+
+// Fills stack with the callers of the allocator, skip is the number of allocator frames above onAlloc()
+static ALLOC_NOINLINE int captureStack(void **stack, int skip)
+{
+	skip += ALLOC_TRACKER_FRAMES;
+
+#ifdef _WIN32
+	return (int)CaptureStackBackTrace((DWORD)skip, ALLOC_SITE_DEPTH, stack, NULL);
+#else
+	void *frames[ALLOC_TRACKER_FRAMES + 8 + ALLOC_SITE_DEPTH];
+	int count = backtrace(frames, std::min(skip + ALLOC_SITE_DEPTH, (int)(sizeof(frames) / sizeof(frames[0]))));
+	int depth = std::max(count - skip, 0);
+	memcpy(stack, frames + skip, depth * sizeof(void *));
+	return depth;
+#endif
+}
+
+ALLOC_NOINLINE void AllocTracker::recordSite(size_t size, int skip)
+{
+	void *stack[ALLOC_SITE_DEPTH];
+	int depth = captureStack(stack, skip);
+
+	std::lock_guard<std::mutex> lock(siteMutex);
+
+	for (int i = 0; i < siteCount; i++)
+	{
+		AllocSite &site = sites[i];
+		if (site.depth == depth && memcmp(site.stack, stack, depth * sizeof(void *)) == 0)
+		{
+			site.count++;
+			site.bytes += size;
+			return;
+		}
+	}
+
+	if (siteCount == ALLOC_SITE_COUNT)
+	{
+		untracked++;
+		return;
+	}
+
+	AllocSite &site = sites[siteCount++];
+	memcpy(site.stack, stack, depth * sizeof(void *));
+	site.depth = depth;
+	site.count = 1;
+	site.bytes = size;
+}
+
+// skip is the number of allocator frames between the caller and this function
+ALLOC_NOINLINE void AllocTracker::onAlloc(size_t size, int skip)
+{
+	allocs.fetch_add(1, std::memory_order_relaxed);
+	bytes.fetch_add(size, std::memory_order_relaxed);
+
+	if (recording.load(std::memory_order_relaxed))
+		recordSite(size, skip);
+}
+
+void AllocTracker::onFree()
+{
+	frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocTracker::setRecordSites(bool record)
+{
+#ifndef _WIN32
+	// The first backtrace() loads the unwinder, which allocates, better now than in the middle of a frame
+	if (record)
+	{
+		void *frame;
+		backtrace(&frame, 1);
+	}
+#endif
+
+	recording.store(record, std::memory_order_relaxed);
+}
+
+void AllocTracker::endFrame()
+{
+	lastFrame.allocs = allocs.exchange(0, std::memory_order_relaxed);
+	lastFrame.frees = frees.exchange(0, std::memory_order_relaxed);
+	lastFrame.bytes = bytes.exchange(0, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(siteMutex);
+
+	memcpy(lastFrame.sites, sites, siteCount * sizeof(AllocSite));
+	lastFrame.siteCount = siteCount;
+	lastFrame.untracked = untracked;
+
+	siteCount = 0;
+	untracked = 0;
+}
+
+void AllocTracker::printLastFrame(FILE *out) const
+{
+	fprintf(out, "%u allocations, %u frees, %zu bytes\n", lastFrame.allocs, lastFrame.frees, lastFrame.bytes);
+
+	int order[ALLOC_SITE_COUNT];
+	for (int i = 0; i < lastFrame.siteCount; i++)
+		order[i] = i;
+
+	std::sort(order, order + lastFrame.siteCount, [this](int a, int b) { return lastFrame.sites[a].count > lastFrame.sites[b].count; });
+
+	for (int i = 0; i < lastFrame.siteCount; i++)
+	{
+		const AllocSite &site = lastFrame.sites[order[i]];
+		fprintf(out, "  %u x, %zu bytes:\n", site.count, site.bytes);
+
+#ifdef _WIN32
+		for (int j = 0; j < site.depth; j++)
+			fprintf(out, "    %p\n", site.stack[j]);
+#else
+		// Writes straight to the file descriptor without allocating
+		fflush(out);
+		backtrace_symbols_fd(site.stack, site.depth, fileno(out));
+#endif
+	}
+
+	if (lastFrame.untracked > 0)
+		fprintf(out, "  %u more from call sites past the first %d\n", lastFrame.untracked, ALLOC_SITE_COUNT);
+}
+
+static void *imguiAlloc(size_t size, void *userData)
+{
+	(void)userData;
+
+	// This and ImGui::MemAlloc()
+	Allocs.onAlloc(size, 2);
+	return malloc(size);
+}
+
+static void imguiFree(void *ptr, void *userData)
+{
+	(void)userData;
+
+	if (ptr)
+		Allocs.onFree();
+
+	free(ptr);
+}
+
+void installImGuiAllocator()
+{
+	ImGui::SetAllocatorFunctions(imguiAlloc, imguiFree, NULL);
+}
+
+// Replacements of the global operators, every new and delete of the program goes through these
+
+static ALLOC_NOINLINE void *trackedNew(size_t size)
+{
+	// This and operator new
+	Allocs.onAlloc(size, 2);
+	return malloc(size ? size : 1);
+}
+
+static void trackedDelete(void *ptr)
+{
+	if (ptr)
+		Allocs.onFree();
+
+	free(ptr);
+}
+
+void *operator new(size_t size)
+{
+	void *ptr = trackedNew(size);
+	if (!ptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void *operator new[](size_t size)
+{
+	void *ptr = trackedNew(size);
+	if (!ptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return trackedNew(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return trackedNew(size); }
+
+void operator delete(void *ptr) noexcept { trackedDelete(ptr); }
+void operator delete[](void *ptr) noexcept { trackedDelete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { trackedDelete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { trackedDelete(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { trackedDelete(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { trackedDelete(ptr); }
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+
+// Frames of the stack kept per call site, starting at the caller of operator new or ImGui::MemAlloc()
+#define ALLOC_SITE_DEPTH	6
+
+// Distinct call sites recorded per frame, the rest only show up in the totals
+#define ALLOC_SITE_COUNT	64
+
+struct AllocSite
+{
+	void *stack[ALLOC_SITE_DEPTH];
+	int depth;
+
+	unsigned count;
+	size_t bytes;
+};
+
+struct AllocFrame
+{
+	unsigned allocs = 0;
+	unsigned frees = 0;
+	size_t bytes = 0;
+
+	AllocSite sites[ALLOC_SITE_COUNT];
+	int siteCount = 0;
+
+	// Allocations whose call site did not fit
+	unsigned untracked = 0;
+};
+
+// Counts the heap allocations of the whole program, from any thread: the global operator new and delete are replaced,
+// and ImGui goes through installImGuiAllocator(). Allocations made with malloc directly (drivers, GLFW, stb) are not seen.
+// Counting is always on and costs a few atomics, call sites are only recorded once recordSites is set
+// since capturing the stack is slow and takes a lock.
+struct AllocTracker
+{
+private:
+	std::atomic<unsigned> allocs{ 0 };
+	std::atomic<unsigned> frees{ 0 };
+	std::atomic<size_t> bytes{ 0 };
+	std::atomic<bool> recording{ false };
+
+	// Call sites of the frame being recorded, fixed size so recording never allocates itself
+	std::mutex siteMutex;
+	AllocSite sites[ALLOC_SITE_COUNT];
+	int siteCount = 0;
+	unsigned untracked = 0;
+
+	void recordSite(size_t size, int skip);
+
+public:
+	// Totals and call sites of the last frame that ended
+	AllocFrame lastFrame;
+
+	void onAlloc(size_t size, int skip);
+	void onFree();
+
+	void setRecordSites(bool record);
+	bool isRecordingSites() const { return recording.load(std::memory_order_relaxed); }
+
+	// Ends the frame being counted and starts the next one, call once per frame from the main thread
+	void endFrame();
+
+	// Call sites of the last frame, most allocations first, with symbols where the platform has them
+	void printLastFrame(FILE *out) const;
+};
+
+extern AllocTracker Allocs;
+
+// Send ImGui's allocations through the tracker, call before ImGui::CreateContext()
+void installImGuiAllocator();
@@ -0,0 +1,604 @@
+// Offscreen benchmark of the render loop, runs scripted scenes with a fixed time step and reports
+// frame time percentiles, draw calls and uploaded bytes per scene as CSV or JSON.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "imgui_impl_opengl3.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "Context.h"
+#include "Shader.h"
+#include "BoxSwarm.h"
+#include "RenderTarget.h"
+#include "TextureAtlas.h"
+
+#define GLSL_VERSION	"#version 330 core"
+
+#define FRAME_TIME		(1.0f / 60.0f)
+#define CHECKER_SIZE	256
+
+// IDs hashed per label set and backend by the ID hash benchmark, repeated until at least this long
+#define HASH_BENCH_IDS		4096
+#define HASH_BENCH_TIME		0.2
+
+struct BenchScene
+{
+	std::string name;
+	int boxes = 0;
+	bool texture = false;
+	bool panels = false;
+	int width = 1280, height = 720;
+	int frames = 300;
+
+	// Swarm boxes bounce off each other, with this half size
+	bool collisions = false;
+	float boxSize = 0.05f;
+};
+
+struct BenchResult
+{
+	BenchScene scene;
+
+	bool failed = false;
+
+	double mean, p50, p95, p99;
+
+	// Averages per frame
+	double drawCalls, uploadBytes;
+};
+
+static const BenchScene DEFAULT_SCENES[] = {
+	{ "empty",			0,		false,	false,	1280,	720,	300 },
+	{ "box_textured",	0,		true,	false,	1280,	720,	300 },
+	{ "swarm_1k",		1000,	false,	false,	1280,	720,	300 },
+	{ "swarm_10k",		10000,	true,	false,	1280,	720,	300 },
+	{ "swarm_100k",		100000,	true,	false,	1280,	720,	300 },
+	{ "panels",			1000,	true,	true,	1280,	720,	300 },
+	{ "res_640",		10000,	true,	true,	640,	360,	300 },
+	{ "res_1920",		10000,	true,	true,	1920,	1080,	300 },
+	{ "res_3840",		10000,	true,	true,	3840,	2160,	300 },
+	{ "collide_10k",	10000,	true,	false,	1280,	720,	300,	true,	0.005f },
+	{ "collide_50k",	50000,	true,	false,	1280,	720,	300,	true,	0.003f }
+};
+
+static bool parseFlag(const std::string &value, bool &out)
+{
+	if (value == "on" || value == "1")
+		out = true;
+	else if (value == "off" || value == "0")
+		out = false;
+	else
+		return false;
+
+	return true;
+}
+
+// One scene per line: name boxes texture panels width height frames [collisions [size]], the flags are on/off.
+// Lines starting with # are comments.
+static bool loadScenes(const char *path, std::vector<BenchScene> &scenes)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		printf("Cannot open scene file %s\n", path);
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		BenchScene scene;
+
+		std::istringstream stream(line);
+		std::string textureValue, panelsValue;
+
+		stream >> scene.name >> scene.boxes >> textureValue >> panelsValue >> scene.width >> scene.height >> scene.frames;
+
+		bool valid = !stream.fail() && parseFlag(textureValue, scene.texture) && parseFlag(panelsValue, scene.panels);
+
+		std::string collisionsValue;
+		if (valid && stream >> collisionsValue)
+		{
+			valid = parseFlag(collisionsValue, scene.collisions);
+
+			if (valid && !(stream >> scene.boxSize))
+				valid = stream.eof();
+		}
+
+		if (!valid || scene.boxes < 0 || scene.width <= 0 || scene.height <= 0 || scene.frames <= 0 || scene.boxSize <= 0.0f)
+		{
+			printf("%s:%d: expected \"name boxes texture panels width height frames [collisions [size]]\"\n", path, lineNumber);
+			return false;
+		}
+
+		scenes.push_back(scene);
+	}
+
+	return true;
+}
+
+static GLuint createCheckerTexture()
+{
+	std::vector<unsigned char> pixels(CHECKER_SIZE * CHECKER_SIZE * 4);
+
+	for (int y = 0; y < CHECKER_SIZE; y++)
+	{
+		for (int x = 0; x < CHECKER_SIZE; x++)
+		{
+			unsigned char value = (((x / 32) + (y / 32)) & 1) ? 255 : 64;
+			unsigned char *pixel = &pixels[(y * CHECKER_SIZE + x) * 4];
+
+			pixel[0] = value;
+			pixel[1] = value;
+			pixel[2] = 255;
+			pixel[3] = 255;
+		}
+	}
+
+	GLuint texture;
+	glGenTextures(1, &texture);
+	GLState.bindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, CHECKER_SIZE, CHECKER_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	return texture;
+}
+
+// Nearest rank, times have to be sorted
+static double getPercentile(const std::vector<double> &times, double percent)
+{
+	size_t rank = (size_t)std::ceil(percent / 100.0 * times.size());
+	return times[std::max(rank, (size_t)1) - 1];
+}
+
+// Every scene starts from fresh objects, so results do not depend on which scenes ran before
+static BenchResult runScene(const BenchScene &scene, JobSystem &jobs, GLuint checker, int warmupFrames)
+{
+	BenchResult result;
+	result.scene = scene;
+
+	RenderTarget target;
+	if (!target.create(scene.width, scene.height))
+	{
+		result.failed = true;
+		return result;
+	}
+
+	Box box("T1_Shader.vert", "T1_Shader.frag", 0.2f, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+	BoxSwarm swarm("T1_Shader_Instanced.vert", "T1_Shader_Instanced.frag", scene.boxSize);
+	TextureAtlas atlas;
+
+	BounceSim boxSim;
+	boxSim.resize(1);
+	boxSim.velX[0] = 0.125f;
+	boxSim.velY[0] = 0.125f;
+
+	if (scene.texture)
+	{
+		box.setTexture(checker, CHECKER_SIZE, CHECKER_SIZE);
+
+		atlas.addLayer(checker, CHECKER_SIZE, CHECKER_SIZE);
+		swarm.setLayerCount(atlas.getLayerCount());
+	}
+
+	swarm.resize(scene.boxes);
+	swarm.setCollisions(scene.collisions);
+
+	ImGuiIO &io = ImGui::GetIO();
+	io.DisplaySize = ImVec2((float)scene.width, (float)scene.height);
+	io.DeltaTime = FRAME_TIME;
+
+	std::vector<double> times;
+	times.reserve(scene.frames);
+
+	GLStats before = {};
+
+	for (int frame = 0; frame < warmupFrames + scene.frames; frame++)
+	{
+		if (frame == warmupFrames)
+			before = GLState.total;
+
+		GLState.beginFrame();
+
+		auto start = std::chrono::steady_clock::now();
+
+		target.bind();
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		ImGui_ImplOpenGL3_NewFrame();
+		ImGui::NewFrame();
+
+		// One step per frame, drawn at the latest state
+		swarm.update(1, FRAME_TIME, 1.0f, jobs);
+
+		if (scene.panels)
+		{
+			ImGui::ShowDemoWindow();
+			ImGui::ShowMetricsWindow();
+		}
+
+		swarm.upload();
+		swarm.draw(atlas);
+
+		boxSim.posX[0] = box.pos.x;
+		boxSim.posY[0] = box.pos.y;
+		boxSim.step(FRAME_TIME);
+		box.pos.x = boxSim.posX[0];
+		box.pos.y = boxSim.posY[0];
+
+		box.model = glm::translate(glm::mat4(1.0f), box.pos);
+		box.setUniform(Uniform_Model, box.model);
+		box.draw();
+
+		ImGui::Render();
+
+		ImDrawData *drawData = ImGui::GetDrawData();
+		ImGui_ImplOpenGL3_RenderDrawData(drawData);
+
+		// The backend streams every vertex and index each frame, draws are one per command or one per batch
+		int uiDraws = 0;
+		ImGui_ImplOpenGL3_GetLastFrameStats(NULL, &uiDraws);
+		GLState.countDraw((unsigned)uiDraws);
+
+		for (int i = 0; i < drawData->CmdListsCount; i++)
+		{
+			const ImDrawList *list = drawData->CmdLists[i];
+			GLState.countUpload(list->VtxBuffer.size_in_bytes() + list->IdxBuffer.size_in_bytes());
+		}
+
+		// Frame time includes the GPU, otherwise only submission would be measured
+		glFinish();
+
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (frame >= warmupFrames)
+			times.push_back(ms);
+	}
+
+	std::sort(times.begin(), times.end());
+
+	double sum = 0.0;
+	for (double time : times)
+		sum += time;
+
+	result.mean = sum / times.size();
+	result.p50 = getPercentile(times, 50.0);
+	result.p95 = getPercentile(times, 95.0);
+	result.p99 = getPercentile(times, 99.0);
+	result.drawCalls = (double)(GLState.total.drawCalls - before.drawCalls) / scene.frames;
+	result.uploadBytes = (double)(GLState.total.uploadBytes - before.uploadBytes) / scene.frames;
+
+	return result;
+}
+
+static void writeCSV(std::ostream &out, const std::vector<BenchResult> &results)
+{
+	char line[512];
+
+	out << "scene,boxes,texture,panels,width,height,frames,collisions,box_size,mean_ms,p50_ms,p95_ms,p99_ms,draw_calls,upload_bytes\n";
+
+	for (const BenchResult &result : results)
+	{
+		const BenchScene &scene = result.scene;
+
+		snprintf(line, sizeof(line), "%s,%d,%d,%d,%d,%d,%d,%d,%g,", scene.name.c_str(), scene.boxes, scene.texture, scene.panels,
+			scene.width, scene.height, scene.frames, scene.collisions, scene.boxSize);
+		out << line;
+
+		if (result.failed)
+		{
+			out << ",,,,,\n";
+			continue;
+		}
+
+		snprintf(line, sizeof(line), "%.4f,%.4f,%.4f,%.4f,%.1f,%.0f\n", result.mean, result.p50, result.p95, result.p99,
+			result.drawCalls, result.uploadBytes);
+		out << line;
+	}
+}
+
+static void writeJSON(std::ostream &out, const std::vector<BenchResult> &results)
+{
+	char line[512];
+
+	out << "{\n\t\"renderer\": \"" << (const char *)glGetString(GL_RENDERER) << "\",\n";
+	out << "\t\"version\": \"" << (const char *)glGetString(GL_VERSION) << "\",\n";
+	out << "\t\"scenes\": [\n";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult &result = results[i];
+		const BenchScene &scene = result.scene;
+
+		snprintf(line, sizeof(line), "\t\t{ \"scene\": \"%s\", \"boxes\": %d, \"texture\": %s, \"panels\": %s, \"width\": %d, \"height\": %d, \"frames\": %d, \"collisions\": %s, \"box_size\": %g",
+			scene.name.c_str(), scene.boxes, scene.texture ? "true" : "false", scene.panels ? "true" : "false",
+			scene.width, scene.height, scene.frames, scene.collisions ? "true" : "false", scene.boxSize);
+		out << line;
+
+		if (result.failed)
+		{
+			out << ", \"failed\": true }";
+		}
+		else
+		{
+			snprintf(line, sizeof(line), ", \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f, \"draw_calls\": %.1f, \"upload_bytes\": %.0f }",
+				result.mean, result.p50, result.p95, result.p99, result.drawCalls, result.uploadBytes);
+			out << line;
+		}
+
+		out << ((i + 1 < results.size()) ? ",\n" : "\n");
+	}
+
+	out << "\t]\n}\n";
+}
+
+static bool writeResults(const char *path, const std::vector<BenchResult> &results, bool json)
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		printf("Cannot write %s\n", path);
+		return false;
+	}
+
+	if (json)
+		writeJSON(file, results);
+	else
+		writeCSV(file, results);
+
+	return true;
+}
+
+// Label sets shaped like the IDs a frame pushes: plain labels, labels with a ### id, long tree paths and PushID(int)
+static void makeHashLabels(int set, std::vector<std::string> &labels)
+{
+	char label[128];
+
+	for (int i = 0; i < HASH_BENCH_IDS; i++)
+	{
+		switch (set)
+		{
+		case 0: snprintf(label, sizeof(label), "Button %d", i); break;
+		case 1: snprintf(label, sizeof(label), "Frame %d: %.3f ms###Stats%d", i, i * 0.25f, i % 8); break;
+		case 2: snprintf(label, sizeof(label), "Settings/GL state cache/Textures/Layer %d/Mip level %d", i, i % 12); break;
+		default: label[0] = 0; break;
+		}
+
+		labels.push_back(label);
+	}
+}
+
+// Hashes IDs with every backend compiled in, ImHashStr() and ImHashData() use the one picked in imconfig.h
+static void runHashBenchmark()
+{
+	static const char *SET_NAMES[] = { "label", "label###id", "long path", "int" };
+
+	printf("ID hash in use: %s\n", ImHashBackendGetName(ImHashBackendGetCurrent()));
+
+	for (int set = 0; set < 4; set++)
+	{
+		std::vector<std::string> labels;
+		makeHashLabels(set, labels);
+
+		size_t bytes = 0;
+		for (const std::string &label : labels)
+			bytes += (set == 3) ? sizeof(int) : label.size();
+
+		for (int backend = 0; backend < ImHashBackend_COUNT; backend++)
+		{
+			if (!ImHashBackendIsAvailable((ImHashBackend)backend))
+			{
+				printf("%-12s %-8s not available in this build\n", SET_NAMES[set], ImHashBackendGetName((ImHashBackend)backend));
+				continue;
+			}
+
+			// Chain the seeds like nested ID stacks do
+			ImGuiID id = 0;
+			long long ids = 0;
+			double elapsed = 0.0;
+
+			auto start = std::chrono::steady_clock::now();
+			while (elapsed < HASH_BENCH_TIME)
+			{
+				for (int i = 0; i < HASH_BENCH_IDS; i++)
+				{
+					if (set == 3)
+						id = ImHashDataEx((ImHashBackend)backend, &i, sizeof(i), id);
+					else
+						id = ImHashStrEx((ImHashBackend)backend, labels[i].c_str(), 0, id);
+				}
+
+				ids += HASH_BENCH_IDS;
+				elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			double passes = (double)ids / HASH_BENCH_IDS;
+			printf("%-12s %-8s %7.2f ns per ID | %8.1f MB/s\n", SET_NAMES[set], ImHashBackendGetName((ImHashBackend)backend),
+				elapsed * 1e9 / ids, bytes * passes / elapsed / (1024.0 * 1024.0));
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const char *scenePath = NULL;
+	const char *csvPath = NULL;
+	const char *jsonPath = NULL;
+	int warmupFrames = 30;
+	int frameOverride = 0;
+	bool multiDraw = false;
+	bool hashBench = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char *arg = argv[i];
+		const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (!value)
+		{
+			printf("Usage: %s [--scenes file] [--csv file] [--json file] [--warmup N] [--frames N] [--mdi on|off] [--hash on|off]\n", argv[0]);
+			return -1;
+		}
+
+		if (strcmp(arg, "--scenes") == 0)
+			scenePath = value;
+		else if (strcmp(arg, "--csv") == 0)
+			csvPath = value;
+		else if (strcmp(arg, "--json") == 0)
+			jsonPath = value;
+		else if (strcmp(arg, "--warmup") == 0)
+			warmupFrames = std::max(atoi(value), 0);
+		else if (strcmp(arg, "--frames") == 0)
+			frameOverride = std::max(atoi(value), 0);
+		else if (strcmp(arg, "--mdi") == 0)
+		{
+			if (!parseFlag(value, multiDraw))
+			{
+				printf("--mdi expects on or off\n");
+				return -1;
+			}
+		}
+		else if (strcmp(arg, "--hash") == 0)
+		{
+			if (!parseFlag(value, hashBench))
+			{
+				printf("--hash expects on or off\n");
+				return -1;
+			}
+		}
+		else
+		{
+			printf("Unknown argument: %s\n", arg);
+			return -1;
+		}
+
+		i++;
+	}
+
+	// Only measures the hash, no context needed
+	if (hashBench)
+	{
+		runHashBenchmark();
+		return 0;
+	}
+
+	std::vector<BenchScene> scenes;
+	if (scenePath)
+	{
+		if (!loadScenes(scenePath, scenes))
+			return -1;
+	}
+	else
+	{
+		scenes.assign(std::begin(DEFAULT_SCENES), std::end(DEFAULT_SCENES));
+	}
+
+	if (frameOverride > 0)
+	{
+		for (BenchScene &scene : scenes)
+			scene.frames = frameOverride;
+	}
+
+	GLFWwindow *window = createContextWindow(640, 360, "ScreensaverGL benchmark", true);
+	if (!window)
+		return -1;
+
+	if (!initContext(window, false))
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return -1;
+	}
+
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext();
+	ImGui::GetIO().IniFilename = NULL;
+	ImGui::StyleColorsDark();
+
+	// No platform backend, display size and time step are set per scene
+	ImGui_ImplOpenGL3_Init(GLSL_VERSION);
+
+	printf("Renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+
+	if (multiDraw && !ImGui_ImplOpenGL3_IsMultiDrawIndirectSupported())
+		printf("Multi-draw indirect is not supported, UI commands are drawn one by one\n");
+
+	ImGui_ImplOpenGL3_SetMultiDrawIndirect(multiDraw);
+
+	std::vector<BenchResult> results;
+
+	{
+		JobSystem jobs;
+		GLuint checker = createCheckerTexture();
+
+		for (const BenchScene &scene : scenes)
+		{
+			BenchResult result = runScene(scene, jobs, checker, warmupFrames);
+
+			if (result.failed)
+				printf("%-16s failed\n", scene.name.c_str());
+			else
+				printf("%-16s p50 %8.3f ms | p95 %8.3f ms | p99 %8.3f ms | %6.0f draws | %10.0f bytes\n",
+					scene.name.c_str(), result.p50, result.p95, result.p99, result.drawCalls, result.uploadBytes);
+
+			results.push_back(result);
+		}
+
+		GLState.forgetTexture(checker);
+		glDeleteTextures(1, &checker);
+	}
+
+	// Results that could not be written fail the run like a failed scene
+	bool written = true;
+
+	if (csvPath)
+		written &= writeResults(csvPath, results, false);
+
+	if (jsonPath)
+		written &= writeResults(jsonPath, results, true);
+
+	if (!csvPath && !jsonPath)
+		writeCSV(std::cout, results);
+
+	Programs.clear();
+
+	ImGui_ImplOpenGL3_Shutdown();
+	ImGui::DestroyContext();
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	bool failed = !written;
+	for (const BenchResult &result : results)
+		failed |= result.failed;
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Collision.h"
+#include "JobSystem.h"
+#include "Shader.h"
+#include "Simulation.h"
+#include "StreamBuffer.h"
+#include "TextureAtlas.h"
+
+// Per-instance data, uploaded as one interleaved buffer.
+// Positions and velocities are owned by the simulation, pos is interpolated from it before every upload.
+struct BoxInstance
+{
+	glm::vec3 pos;
+	ImVec4 color;
+	float layer;
+};
+
+// Many boxes sharing one quad, one program and one texture array, drawn with a single glDrawElementsInstanced call.
+// Each instance picks its logo by layer.
+struct BoxSwarm : public Shader
+{
+private:
+	StreamBuffer instanceStream;
+
+	// upload() pointed the attributes at this frame's data, draw() fences it
+	bool uploaded = false;
+
+	std::vector<BoxInstance> instances;
+
+	std::mt19937 rng;
+
+	int layerCount = 0;
+
+	// Entities per job, a multiple of the widest SIMD kernel
+	static constexpr size_t SIM_CHUNK_SIZE = 16384;
+
+	JobFence simFence;
+	int stepCount = 0;
+	float stepTime = 0.0f;
+	float stepAlpha = 0.0f;
+
+	// Box-box collisions, only between boxes of the swarm
+	bool collisions = false;
+	CollisionGrid grid;
+
+	// All steps of a frame run back to back on one chunk while it is in cache.
+	// With collisions on there is a single chunk, boxes anywhere can push each other.
+	static void stepChunk(void *data, size_t begin, size_t end)
+	{
+		BoxSwarm *swarm = (BoxSwarm *)data;
+		BounceSim &sim = swarm->sim;
+
+		for (int step = 0; step < swarm->stepCount; step++)
+		{
+			if (step == swarm->stepCount - 1)
+				sim.savePrevious(begin, end);
+
+			sim.step(swarm->stepTime, begin, end);
+
+			if (swarm->collisions)
+				swarm->grid.resolve(sim, swarm->size);
+		}
+
+		for (size_t i = begin; i < end; i++)
+		{
+			swarm->instances[i].pos.x = sim.getX(i, swarm->stepAlpha);
+			swarm->instances[i].pos.y = sim.getY(i, swarm->stepAlpha);
+		}
+	}
+
+public:
+	float size;
+
+	BounceSim sim;
+
+	// Collision counters of the last step, copied once the steps are done so the UI can read them any time
+	unsigned pairsTested = 0;
+	unsigned contacts = 0;
+
+	BoxSwarm(const char *vf, const char *ff, float size)
+	{
+		this->size = size;
+
+		create(size, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+		createShader(vf, ff);
+		createBufferData();
+
+		// Attributes are pointed at this frame's region of the stream in upload()
+		GLState.bindVertexArray(VAO);
+
+		for (GLuint attribute = 2; attribute <= 4; attribute++)
+		{
+			glEnableVertexAttribArray(attribute);
+			glVertexAttribDivisor(attribute, 1);
+		}
+
+		GLState.bindVertexArray(0);
+	}
+
+	~BoxSwarm()
+	{
+		simFence.wait();
+	}
+
+	// Grow or shrink the swarm, new boxes get a random position, direction and color.
+	void resize(int count)
+	{
+		std::uniform_real_distribution<float> posX(sim.bounds.minX, sim.bounds.maxX);
+		std::uniform_real_distribution<float> posY(sim.bounds.minY, sim.bounds.maxY);
+		std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+		std::uniform_real_distribution<float> channel(0.25f, 1.0f);
+
+		simFence.wait();
+
+		size_t oldCount = instances.size();
+		instances.resize(count);
+		sim.resize(count);
+
+		for (size_t i = oldCount; i < instances.size(); i++)
+		{
+			float a = angle(rng);
+
+			sim.teleport(i, posX(rng), posY(rng));
+			sim.velX[i] = std::cos(a) * 0.125f;
+			sim.velY[i] = std::sin(a) * 0.125f;
+
+			BoxInstance &inst = instances[i];
+			inst.pos = glm::vec3(0.0f);
+			inst.color = ImVec4(channel(rng), channel(rng), channel(rng), 1.0f);
+			inst.layer = (layerCount > 0) ? (float)(i % layerCount) : 0.0f;
+		}
+	}
+
+	// Half size of every box, also the extent used for collisions
+	void setBoxSize(float size)
+	{
+		simFence.wait();
+
+		this->size = size;
+		resizeQuad(size);
+	}
+
+	void setCollisions(bool enabled)
+	{
+		simFence.wait();
+
+		collisions = enabled;
+		pairsTested = 0;
+		contacts = 0;
+	}
+
+	bool getCollisions() const
+	{
+		return collisions;
+	}
+
+	// Spread the boxes evenly over the first layerCount layers of the atlas
+	void setLayerCount(int layerCount)
+	{
+		simFence.wait();
+
+		this->layerCount = layerCount;
+
+		for (size_t i = 0; i < instances.size(); i++)
+			instances[i].layer = (layerCount > 0) ? (float)(i % layerCount) : 0.0f;
+	}
+
+	// Queue this frame's fixed steps on the worker threads, each chunk also writes its positions, blended
+	// between the last two steps by alpha, into the instance array. Runs even without steps, alpha still moves.
+	// Returns right away, upload() waits for the steps to finish.
+	void update(int steps, float stepTime, float alpha, JobSystem &jobs)
+	{
+		simFence.wait();
+
+		stepCount = steps;
+		this->stepTime = stepTime;
+		stepAlpha = alpha;
+		jobs.parallelFor(sim.size(), collisions ? 0 : SIM_CHUNK_SIZE, stepChunk, this, simFence);
+	}
+
+	// Copy the instance array into this frame's region of the stream, the GPU may still be reading the
+	// regions of the last frames. Writes straight into mapped memory when the driver has buffer storage.
+	void upload()
+	{
+		simFence.wait();
+
+		if (collisions)
+		{
+			pairsTested = grid.pairsTested;
+			contacts = grid.contacts;
+		}
+
+		if (instances.empty())
+			return;
+
+		GLsizeiptr bytes = (GLsizeiptr)(instances.size() * sizeof(BoxInstance));
+
+		instanceStream.beginFrame();
+
+		GLintptr offset;
+		void *data = instanceStream.allocate(bytes, sizeof(BoxInstance), offset);
+		if (!data)
+		{
+			instanceStream.endFrame();
+			return;
+		}
+
+		memcpy(data, instances.data(), bytes);
+		instanceStream.commit();
+		GLState.countUpload(bytes);
+
+		// The region moves every frame, so the attributes are pointed at it again
+		GLState.bindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceStream.getBuffer());
+
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(BoxInstance), (GLvoid *)(offset + offsetof(BoxInstance, pos)));
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(BoxInstance), (GLvoid *)(offset + offsetof(BoxInstance, color)));
+		glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(BoxInstance), (GLvoid *)(offset + offsetof(BoxInstance, layer)));
+
+		uploaded = true;
+	}
+
+	// Draw every instance at once, boxes are plain colored while the atlas is empty.
+	void draw(const TextureAtlas &atlas)
+	{
+		if (instances.empty() || !uploaded)
+			return;
+
+		this->use();
+
+		bool useTexture = atlas.getLayerCount() > 0;
+		GLState.setUniform(*this->reflection, Uniform_UseTexture, useTexture);
+
+		if (useTexture)
+			GLState.bindTexture(GL_TEXTURE_2D_ARRAY, atlas.getTexture());
+
+		GLState.bindVertexArray(VAO);
+		glDrawElementsInstanced(GL_TRIANGLES, sizeof(this->indices) / sizeof(int), GL_UNSIGNED_INT, 0, (GLsizei)instances.size());
+		GLState.countDraw();
+
+		instanceStream.endFrame();
+		uploaded = false;
+	}
+
+	const StreamBuffer &getInstanceStream() const
+	{
+		return instanceStream;
+	}
+
+	int getCount()
+	{
+		return (int)this->instances.size();
+	}
+};
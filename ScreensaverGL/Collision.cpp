@@ -0,0 +1,161 @@
+#include "Collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+int CollisionGrid::getCell(float x, float y) const
+{
+	// Pushing boxes apart can move them slightly out of bounds, those share the border cells
+	int cx = (int)((x - originX) * inverseCellSize);
+	int cy = (int)((y - originY) * inverseCellSize);
+
+	cx = std::min(std::max(cx, 0), columns - 1);
+	cy = std::min(std::max(cy, 0), rows - 1);
+
+	return cy * columns + cx;
+}
+
+void CollisionGrid::build(const BounceSim &sim, float halfSize)
+{
+	const SimBounds &bounds = sim.bounds;
+
+	float width = bounds.maxX - bounds.minX;
+	float height = bounds.maxY - bounds.minY;
+
+	// Cells at least one box wide, tiny boxes get bigger cells rather than an enormous grid
+	float cellSize = std::max(2.0f * halfSize, std::max(width, height) / MAX_CELLS_PER_AXIS);
+
+	originX = bounds.minX;
+	originY = bounds.minY;
+	inverseCellSize = 1.0f / cellSize;
+	columns = std::max(1, (int)std::ceil(width * inverseCellSize));
+	rows = std::max(1, (int)std::ceil(height * inverseCellSize));
+
+	size_t cells = (size_t)columns * rows;
+	size_t count = sim.size();
+
+	cellStart.assign(cells + 1, 0);
+	entities.resize(count);
+	entityCell.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		int cell = getCell(sim.posX[i], sim.posY[i]);
+
+		entityCell[i] = (uint32_t)cell;
+		cellStart[cell + 1]++;
+	}
+
+	for (size_t c = 0; c < cells; c++)
+		cellStart[c + 1] += cellStart[c];
+
+	cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+
+	posX.resize(count);
+	posY.resize(count);
+	velX.resize(count);
+	velY.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t k = cellFill[entityCell[i]]++;
+
+		entities[k] = (uint32_t)i;
+		posX[k] = sim.posX[i];
+		posY[k] = sim.posY[i];
+		velX[k] = sim.velX[i];
+		velY[k] = sim.velY[i];
+	}
+}
+
+bool CollisionGrid::resolvePair(uint32_t a, uint32_t b, float extent)
+{
+	float dx = posX[b] - posX[a];
+	float dy = posY[b] - posY[a];
+
+	float overlapX = extent - std::fabs(dx);
+	float overlapY = extent - std::fabs(dy);
+
+	if ((overlapX <= 0.0f) | (overlapY <= 0.0f))
+		return false;
+
+	// Equal masses, an elastic bounce swaps the velocities along the normal if the boxes are closing in
+	if (overlapX < overlapY)
+	{
+		float push = (dx < 0.0f) ? -0.5f * overlapX : 0.5f * overlapX;
+		posX[a] -= push;
+		posX[b] += push;
+
+		if ((velX[b] - velX[a]) * dx < 0.0f)
+			std::swap(velX[a], velX[b]);
+	}
+	else
+	{
+		float push = (dy < 0.0f) ? -0.5f * overlapY : 0.5f * overlapY;
+		posY[a] -= push;
+		posY[b] += push;
+
+		if ((velY[b] - velY[a]) * dy < 0.0f)
+			std::swap(velY[a], velY[b]);
+	}
+
+	return true;
+}
+
+void CollisionGrid::resolve(BounceSim &sim, float halfSize)
+{
+	pairsTested = 0;
+	contacts = 0;
+
+	if (sim.size() < 2)
+		return;
+
+	build(sim, halfSize);
+
+	float extent = 2.0f * halfSize;
+
+	// Every pair is visited once. Cells are stored row by row, so the rest of this cell plus the cell to the
+	// right is one contiguous range, and so are the three cells below.
+	for (int cy = 0; cy < rows; cy++)
+	{
+		for (int cx = 0; cx < columns; cx++)
+		{
+			int cell = cy * columns + cx;
+			uint32_t begin = cellStart[cell], end = cellStart[cell + 1];
+
+			if (begin == end)
+				continue;
+
+			uint32_t sideEnd = cellStart[(cx + 1 < columns) ? cell + 2 : cell + 1];
+
+			uint32_t belowBegin = 0, belowEnd = 0;
+			if (cy + 1 < rows)
+			{
+				int below = cell + columns;
+				belowBegin = cellStart[(cx > 0) ? below - 1 : below];
+				belowEnd = cellStart[(cx + 1 < columns) ? below + 2 : below + 1];
+			}
+
+			for (uint32_t a = begin; a < end; a++)
+			{
+				for (uint32_t b = a + 1; b < sideEnd; b++)
+					contacts += resolvePair(a, b, extent);
+
+				for (uint32_t b = belowBegin; b < belowEnd; b++)
+					contacts += resolvePair(a, b, extent);
+
+				pairsTested += (sideEnd - a - 1) + (belowEnd - belowBegin);
+			}
+		}
+	}
+
+	for (size_t k = 0; k < entities.size(); k++)
+	{
+		uint32_t i = entities[k];
+
+		sim.posX[i] = posX[k];
+		sim.posY[i] = posY[k];
+		sim.velX[i] = velX[k];
+		sim.velY[i] = velY[k];
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Simulation.h"
+
+// Broadphase for equally sized boxes: a uniform grid over the simulation bounds, one cell per box width,
+// so a box can only touch boxes in its own and the 8 surrounding cells.
+// Rebuilt every step with a counting sort, count per cell, prefix sum, then scatter, which is O(N)
+// and allocation free once the arrays have grown to fit. The scatter also copies positions and velocities
+// into cell order, so the narrowphase walks contiguous memory and writes the results back once at the end.
+struct CollisionGrid
+{
+private:
+	static constexpr int MAX_CELLS_PER_AXIS = 2048;
+
+	float originX = 0.0f, originY = 0.0f;
+	float inverseCellSize = 1.0f;
+	int columns = 0, rows = 0;
+
+	// Entities of cell c are entities[cellStart[c] .. cellStart[c + 1])
+	std::vector<uint32_t> cellStart;
+	std::vector<uint32_t> cellFill;
+	std::vector<uint32_t> entities;
+	std::vector<uint32_t> entityCell;
+
+	// Sorted copies of the simulation state, index k belongs to entities[k]
+	std::vector<float> posX, posY, velX, velY;
+
+	int getCell(float x, float y) const;
+
+	void build(const BounceSim &sim, float halfSize);
+
+	// Narrowphase of one pair of sorted indices, returns whether they overlapped
+	bool resolvePair(uint32_t a, uint32_t b, float extent);
+
+public:
+	// Counters of the last resolve()
+	unsigned pairsTested = 0;
+	unsigned contacts = 0;
+
+	// Push overlapping boxes apart along the axis of least penetration and bounce them elastically.
+	// All boxes are squares with the same half size and equal mass.
+	void resolve(BounceSim &sim, float halfSize);
+};
@@ -0,0 +1,86 @@
+#include "Context.h"
+
+#include <cstdio>
+
+#include "GLExt.h"
+
+static void setContextHints()
+{
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+}
+
+// Headless runs on build machines without a display or a GPU. GLFW 3.4 can skip the window system
+// entirely and create an OSMesa (llvmpipe) context, otherwise fall back to a hidden window with an EGL context.
+static GLFWwindow *createHeadlessWindow(int width, int height, const char *title)
+{
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+	glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+	if (glfwInit())
+	{
+		setContextHints();
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+
+		GLFWwindow *window = glfwCreateWindow(width, height, title, NULL, NULL);
+		if (window)
+			return window;
+
+		glfwTerminate();
+	}
+
+	glfwInitHint(GLFW_PLATFORM, GLFW_ANY_PLATFORM);
+#endif
+
+	if (!glfwInit())
+		return NULL;
+
+	setContextHints();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef __linux__
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#endif
+
+	return glfwCreateWindow(width, height, title, NULL, NULL);
+}
+
+GLFWwindow *createContextWindow(int width, int height, const char *title, bool headless)
+{
+	GLFWwindow *window;
+	if (headless)
+	{
+		window = createHeadlessWindow(width, height, title);
+	}
+	else
+	{
+		glfwInit();
+		setContextHints();
+
+		window = glfwCreateWindow(width, height, title, NULL, NULL);
+	}
+
+	if (!window)
+	{
+		printf("Cannot create Window for GLFW!\n");
+		glfwTerminate();
+	}
+
+	return window;
+}
+
+bool initContext(GLFWwindow *window, bool vsync)
+{
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(vsync ? 1 : 0);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		printf("Failed to initialize GLAD\n");
+		return false;
+	}
+
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	return true;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Initializes GLFW and creates a window with a GL 3.3 core context.
+// A headless window is never shown and does not need a display server where GLFW can avoid one.
+// Returns NULL on failure, GLFW is terminated again in that case.
+GLFWwindow *createContextWindow(int width, int height, const char *title, bool headless);
+
+// Make the context current and load GL through glad, plus the extensions in GLExt.
+bool initContext(GLFWwindow *window, bool vsync);
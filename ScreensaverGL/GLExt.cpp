@@ -0,0 +1,50 @@
+#include "GLExt.h"
+
+#include <cstring>
+
+GLExtensions GLExt;
+
+bool hasGLExtension(const char *name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+	for (GLint i = 0; i < count; i++)
+	{
+		const char *ext = (const char *)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+		if (ext && strcmp(ext, name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+	glGetIntegerv(GL_MAJOR_VERSION, &GLExt.major);
+	glGetIntegerv(GL_MINOR_VERSION, &GLExt.minor);
+
+	if (GLExt.hasVersion(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))
+	{
+		GLExt.BufferStorage = (PFNGLBUFFERSTORAGEPROC_EXT)load("glBufferStorage");
+		GLExt.bufferStorage = GLExt.BufferStorage != nullptr;
+	}
+
+	if (GLExt.hasVersion(4, 1) || hasGLExtension("GL_ARB_get_program_binary"))
+	{
+		GLExt.GetProgramBinary = (PFNGLGETPROGRAMBINARYPROC_EXT)load("glGetProgramBinary");
+		GLExt.ProgramBinary = (PFNGLPROGRAMBINARYPROC_EXT)load("glProgramBinary");
+		GLExt.ProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC_EXT)load("glProgramParameteri");
+
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+		GLExt.programBinary = GLExt.GetProgramBinary && GLExt.ProgramBinary && GLExt.ProgramParameteri && formats > 0;
+	}
+
+	if (GLExt.hasVersion(4, 3) || (hasGLExtension("GL_ARB_multi_draw_indirect") && hasGLExtension("GL_ARB_base_instance")))
+	{
+		GLExt.MultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT)load("glMultiDrawElementsIndirect");
+		GLExt.multiDrawIndirect = GLExt.MultiDrawElementsIndirect != nullptr;
+	}
+}
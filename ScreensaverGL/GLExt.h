@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// glad is generated for GL 3.3 core only, newer entry points and tokens are declared here
+// and loaded at runtime when the driver exposes them.
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT		0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT			0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT		0x0100
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT		0x0200
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH	0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS	0x87FE
+#endif
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER		0x8F3F
+#endif
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC_EXT)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC_EXT)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC_EXT)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC_EXT)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+// Layout of one command in a GL_DRAW_INDIRECT_BUFFER for the indexed indirect draws
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+struct GLExtensions
+{
+	// GL 4.4 or ARB_buffer_storage, needed for persistently mapped buffers
+	bool bufferStorage = false;
+
+	PFNGLBUFFERSTORAGEPROC_EXT BufferStorage = nullptr;
+
+	// GL 4.1 or ARB_get_program_binary, with at least one binary format the driver can hand back
+	bool programBinary = false;
+
+	PFNGLGETPROGRAMBINARYPROC_EXT GetProgramBinary = nullptr;
+	PFNGLPROGRAMBINARYPROC_EXT ProgramBinary = nullptr;
+	PFNGLPROGRAMPARAMETERIPROC_EXT ProgramParameteri = nullptr;
+
+	// GL 4.3, or ARB_multi_draw_indirect plus ARB_base_instance so baseInstance is honored
+	bool multiDrawIndirect = false;
+
+	PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT MultiDrawElementsIndirect = nullptr;
+
+	int major = 0, minor = 0;
+
+	bool hasVersion(int wantMajor, int wantMinor) const
+	{
+		return major > wantMajor || (major == wantMajor && minor >= wantMinor);
+	}
+};
+
+extern GLExtensions GLExt;
+
+// Call once after gladLoadGLLoader(), with the same loader.
+void loadGLExtensions(GLADloadproc load);
+
+bool hasGLExtension(const char *name);
@@ -0,0 +1,217 @@
+#include "GLState.h"
+
+#include <cstring>
+
+GLStateCache GLState;
+
+static const char *uniformNames[Uniform_COUNT] = {
+	"uModel",
+	"uView",
+	"uProjection",
+	"uColor",
+	"uUseTexture",
+	"uTexture"
+};
+
+static const char *statNames[GLStat_COUNT] = {
+	"Program",
+	"Texture",
+	"Vertex array",
+	"Uniform"
+};
+
+const char *getShaderUniformName(ShaderUniform uniform)
+{
+	return uniformNames[uniform];
+}
+
+const char *getGLStatName(GLStat stat)
+{
+	return statNames[stat];
+}
+
+void ShaderReflection::clear()
+{
+	uniforms.clear();
+
+	for (int i = 0; i < Uniform_COUNT; i++)
+	{
+		locations[i] = -1;
+		hasValue[i] = false;
+	}
+}
+
+void ShaderReflection::reflect(GLuint program)
+{
+	clear();
+
+	GLint count = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+
+	char name[256];
+	for (GLint i = 0; i < count; i++)
+	{
+		UniformInfo info;
+		GLsizei length = 0;
+
+		glGetActiveUniform(program, (GLuint)i, sizeof(name), &length, &info.size, &info.type, name);
+
+		// Arrays are reported as "name[0]"
+		char *bracket = strchr(name, '[');
+		if (bracket)
+			*bracket = '\0';
+
+		info.name = name;
+		info.location = glGetUniformLocation(program, name);
+
+		for (int u = 0; u < Uniform_COUNT; u++)
+		{
+			if (info.name == uniformNames[u])
+				locations[u] = info.location;
+		}
+
+		uniforms.push_back(info);
+	}
+}
+
+void GLStateCache::count(GLStat stat, bool skipped)
+{
+	if (skipped)
+	{
+		current.skipped[stat]++;
+		total.skipped[stat]++;
+	}
+	else
+	{
+		current.issued[stat]++;
+		total.issued[stat]++;
+	}
+}
+
+void GLStateCache::countDraw(unsigned calls)
+{
+	current.drawCalls += calls;
+	total.drawCalls += calls;
+}
+
+void GLStateCache::countUpload(size_t bytes)
+{
+	current.uploadBytes += bytes;
+	total.uploadBytes += bytes;
+}
+
+void GLStateCache::invalidate()
+{
+	program = UNKNOWN;
+	vertexArray = UNKNOWN;
+	activeUnit = UNKNOWN;
+
+	for (int i = 0; i < TEXTURE_UNITS; i++)
+	{
+		textures[i] = UNKNOWN;
+		textureTargets[i] = UNKNOWN;
+	}
+}
+
+void GLStateCache::beginFrame()
+{
+	lastFrame = current;
+	current = {};
+}
+
+void GLStateCache::useProgram(GLuint id)
+{
+	bool skip = program == id;
+	count(GLStat_Program, skip);
+
+	if (skip)
+		return;
+
+	glUseProgram(id);
+	program = id;
+}
+
+void GLStateCache::bindVertexArray(GLuint id)
+{
+	bool skip = vertexArray == id;
+	count(GLStat_VertexArray, skip);
+
+	if (skip)
+		return;
+
+	glBindVertexArray(id);
+	vertexArray = id;
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint id, int unit)
+{
+	bool skip = textures[unit] == id && textureTargets[unit] == target;
+	count(GLStat_Texture, skip);
+
+	if (skip)
+		return;
+
+	GLenum unitEnum = GL_TEXTURE0 + unit;
+	if (activeUnit != unitEnum)
+	{
+		glActiveTexture(unitEnum);
+		activeUnit = unitEnum;
+	}
+
+	glBindTexture(target, id);
+	textures[unit] = id;
+	textureTargets[unit] = target;
+}
+
+void GLStateCache::forgetTexture(GLuint id)
+{
+	for (int i = 0; i < TEXTURE_UNITS; i++)
+	{
+		if (textures[i] == id)
+			textures[i] = UNKNOWN;
+	}
+}
+
+bool GLStateCache::sameValue(ShaderReflection &reflection, ShaderUniform uniform, const void *value, size_t bytes)
+{
+	bool same = reflection.hasValue[uniform] && memcmp(reflection.values[uniform], value, bytes) == 0;
+
+	if (!same)
+	{
+		memcpy(reflection.values[uniform], value, bytes);
+		reflection.hasValue[uniform] = true;
+	}
+
+	count(GLStat_Uniform, same);
+
+	return same;
+}
+
+void GLStateCache::setUniform(ShaderReflection &reflection, ShaderUniform uniform, int value)
+{
+	GLint location = reflection.getLocation(uniform);
+	if (location < 0 || sameValue(reflection, uniform, &value, sizeof(value)))
+		return;
+
+	glUniform1i(location, value);
+}
+
+void GLStateCache::setUniform(ShaderReflection &reflection, ShaderUniform uniform, float x, float y, float z, float w)
+{
+	float value[4] = { x, y, z, w };
+
+	GLint location = reflection.getLocation(uniform);
+	if (location < 0 || sameValue(reflection, uniform, value, sizeof(value)))
+		return;
+
+	glUniform4f(location, x, y, z, w);
+}
+
+void GLStateCache::setUniform(ShaderReflection &reflection, ShaderUniform uniform, const float *matrix4)
+{
+	GLint location = reflection.getLocation(uniform);
+	if (location < 0 || sameValue(reflection, uniform, matrix4, 16 * sizeof(float)))
+		return;
+
+	glUniformMatrix4fv(location, 1, GL_FALSE, matrix4);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Uniforms the app knows about, looked up by constant index instead of by name every frame.
+enum ShaderUniform
+{
+	Uniform_Model,
+	Uniform_View,
+	Uniform_Projection,
+	Uniform_Color,
+	Uniform_UseTexture,
+	Uniform_Texture,
+	Uniform_COUNT
+};
+
+const char *getShaderUniformName(ShaderUniform uniform);
+
+// Active uniforms of a linked program, enumerated once right after linking.
+// Also remembers the last value written to each known uniform, since uniform values are per-program state.
+struct ShaderReflection
+{
+	struct UniformInfo
+	{
+		std::string name;
+		GLint location;
+		GLenum type;
+		GLint size;
+	};
+
+	std::vector<UniformInfo> uniforms;
+
+	GLint locations[Uniform_COUNT];
+
+	// Last written value, compared bytewise. Big enough for a mat4.
+	float values[Uniform_COUNT][16];
+	bool hasValue[Uniform_COUNT];
+
+	ShaderReflection() { clear(); }
+
+	void clear();
+
+	void reflect(GLuint program);
+
+	GLint getLocation(ShaderUniform uniform) const { return locations[uniform]; }
+};
+
+enum GLStat
+{
+	GLStat_Program,
+	GLStat_Texture,
+	GLStat_VertexArray,
+	GLStat_Uniform,
+	GLStat_COUNT
+};
+
+const char *getGLStatName(GLStat stat);
+
+struct GLStats
+{
+	unsigned issued[GLStat_COUNT];
+	unsigned skipped[GLStat_COUNT];
+
+	unsigned drawCalls;
+
+	// Buffer and texture data handed to GL
+	size_t uploadBytes;
+};
+
+// Shadow copy of the bits of GL state the app touches, writes that would not change anything are skipped.
+// Code that changes these bindings behind the cache's back has to call invalidate() afterwards.
+struct GLStateCache
+{
+private:
+	static constexpr int TEXTURE_UNITS = 8;
+
+	// Value that never matches a real binding, used for "unknown"
+	static constexpr GLuint UNKNOWN = (GLuint)-1;
+
+	GLuint program = UNKNOWN;
+	GLuint vertexArray = UNKNOWN;
+	GLenum activeUnit = UNKNOWN;
+	GLuint textures[TEXTURE_UNITS];
+	GLenum textureTargets[TEXTURE_UNITS];
+
+	GLStats current = {};
+
+	void count(GLStat stat, bool skipped);
+
+	bool sameValue(ShaderReflection &reflection, ShaderUniform uniform, const void *value, size_t bytes);
+
+public:
+	// Counters of the previous frame
+	GLStats lastFrame = {};
+
+	// Totals since startup
+	GLStats total = {};
+
+	GLStateCache() { invalidate(); }
+
+	void invalidate();
+
+	void beginFrame();
+
+	void useProgram(GLuint id);
+	void bindVertexArray(GLuint id);
+	void bindTexture(GLenum target, GLuint id, int unit = 0); // unit < 8
+
+	// Drop a texture from the cache before it is deleted, GL may hand the same name out again.
+	void forgetTexture(GLuint id);
+
+	// Not cached, only counted
+	void countDraw(unsigned calls = 1);
+	void countUpload(size_t bytes);
+
+	// Uniform setters, reflection has to belong to the program currently in use.
+	void setUniform(ShaderReflection &reflection, ShaderUniform uniform, int value);
+	void setUniform(ShaderReflection &reflection, ShaderUniform uniform, float x, float y, float z, float w);
+	void setUniform(ShaderReflection &reflection, ShaderUniform uniform, const float *matrix4);
+};
+
+extern GLStateCache GLState;
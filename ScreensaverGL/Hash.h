@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a, used for cache keys. Chain calls by passing the previous result as seed.
+inline uint64_t hashBytes(const void *data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	uint64_t hash = seed;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
@@ -0,0 +1,181 @@
+#include "JobSystem.h"
+
+// Index of the worker running on this thread, -1 on threads that are not part of a pool
+static thread_local int tlsWorkerIndex = -1;
+
+// The count drops and the waiters are woken under the lock, and wait() always takes it,
+// so wait() cannot return while the last signal() still uses the fence, which its owner may destroy right after.
+void JobFence::signal()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		cv.notify_all();
+}
+
+void JobFence::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	cv.wait(lock, [this] { return done(); });
+}
+
+bool JobSystem::WorkerQueue::push(const Job &job)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (count == QUEUE_CAPACITY)
+		return false;
+
+	jobs[(head + count) % QUEUE_CAPACITY] = job;
+	count++;
+
+	return true;
+}
+
+bool JobSystem::WorkerQueue::popBack(Job &job)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (count == 0)
+		return false;
+
+	count--;
+	job = jobs[(head + count) % QUEUE_CAPACITY];
+
+	return true;
+}
+
+bool JobSystem::WorkerQueue::popFront(Job &job)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (count == 0)
+		return false;
+
+	job = jobs[head];
+	head = (head + 1) % QUEUE_CAPACITY;
+	count--;
+
+	return true;
+}
+
+JobSystem::JobSystem(int workerCount)
+{
+	if (workerCount <= 0)
+		workerCount = (int)std::thread::hardware_concurrency();
+
+	// Single core machines run every job inline on submit
+	if (workerCount <= 1)
+		return;
+
+	queues = std::vector<WorkerQueue>(workerCount);
+
+	threads.reserve(workerCount);
+	for (int i = 0; i < workerCount; i++)
+		threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+	sleepCv.notify_all();
+
+	for (std::thread &t : threads)
+		t.join();
+}
+
+void JobSystem::run(const Job &job)
+{
+	job.func(job.data, job.begin, job.end);
+
+	if (job.fence)
+		job.fence->signal();
+}
+
+bool JobSystem::findJob(int index, Job &job)
+{
+	if (queues[index].popBack(job))
+		return true;
+
+	int workerCount = (int)queues.size();
+	for (int i = 1; i < workerCount; i++)
+	{
+		if (queues[(index + i) % workerCount].popFront(job))
+			return true;
+	}
+
+	return false;
+}
+
+void JobSystem::workerLoop(int index)
+{
+	tlsWorkerIndex = index;
+
+	Job job;
+	while (running)
+	{
+		if (findJob(index, job))
+		{
+			queued.fetch_sub(1, std::memory_order_relaxed);
+			run(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCv.wait(lock, [this] { return !running || queued.load(std::memory_order_relaxed) > 0; });
+	}
+}
+
+void JobSystem::submit(const Job &job)
+{
+	if (threads.empty())
+	{
+		run(job);
+		return;
+	}
+
+	// Workers keep their own jobs local, other threads spread them round-robin
+	int index = tlsWorkerIndex;
+	if (index < 0)
+		index = (int)(nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size());
+
+	if (!queues[index].push(job))
+	{
+		run(job);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		queued.fetch_add(1, std::memory_order_relaxed);
+	}
+	sleepCv.notify_one();
+}
+
+void JobSystem::parallelFor(size_t count, size_t chunkSize, JobFunc func, void *data, JobFence &fence)
+{
+	if (count == 0)
+		return;
+
+	if (chunkSize == 0)
+		chunkSize = count;
+
+	size_t chunks = (count + chunkSize - 1) / chunkSize;
+	fence.add((int)chunks);
+
+	Job job;
+	job.func = func;
+	job.data = data;
+	job.fence = &fence;
+
+	for (size_t begin = 0; begin < count; begin += chunkSize)
+	{
+		job.begin = begin;
+		job.end = (begin + chunkSize < count) ? begin + chunkSize : count;
+
+		submit(job);
+	}
+}
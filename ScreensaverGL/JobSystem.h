@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef void (*JobFunc)(void *data, size_t begin, size_t end);
+
+// Counts outstanding jobs, wait() blocks until all jobs tied to it have finished.
+struct JobFence
+{
+private:
+	std::atomic<int> pending{ 0 };
+
+	std::mutex mutex;
+	std::condition_variable cv;
+
+public:
+	void add(int count) { pending.fetch_add(count, std::memory_order_relaxed); }
+
+	void signal();
+
+	void wait();
+
+	bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// A chunk of work, a plain function pointer and a range so queuing a job never allocates.
+struct Job
+{
+	JobFunc func = nullptr;
+	void *data = nullptr;
+	size_t begin = 0, end = 0;
+
+	JobFence *fence = nullptr;
+};
+
+// Pool of worker threads, each with its own job deque.
+// Workers pop from the back of their own deque and steal from the front of the others when they run dry.
+struct JobSystem
+{
+private:
+	static constexpr size_t QUEUE_CAPACITY = 1024;
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+
+		Job jobs[QUEUE_CAPACITY];
+		size_t head = 0, count = 0;
+
+		bool push(const Job &job);
+		bool popBack(Job &job);
+		bool popFront(Job &job);
+	};
+
+	std::vector<std::thread> threads;
+	std::vector<WorkerQueue> queues;
+
+	std::atomic<bool> running{ true };
+	std::atomic<int> queued{ 0 };
+	std::atomic<unsigned> nextQueue{ 0 };
+
+	std::mutex sleepMutex;
+	std::condition_variable sleepCv;
+
+	void workerLoop(int index);
+
+	bool findJob(int index, Job &job);
+
+	static void run(const Job &job);
+
+public:
+	// workerCount = 0 uses one worker per hardware thread.
+	explicit JobSystem(int workerCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem &) = delete;
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	void submit(const Job &job);
+
+	// Split [0, count) into chunks of chunkSize and queue one job per chunk, all signaling the same fence.
+	void parallelFor(size_t count, size_t chunkSize, JobFunc func, void *data, JobFence &fence);
+
+	int getWorkerCount() const { return (int)threads.size(); }
+};
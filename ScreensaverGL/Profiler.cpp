@@ -0,0 +1,359 @@
+#include "Profiler.h"
+
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include "Hash.h"
+
+Profiler Profile;
+
+Profiler::Profiler()
+	: epoch(std::chrono::steady_clock::now())
+{
+}
+
+void Profiler::shutdown()
+{
+	for (ProfileFrame &frame : frames)
+	{
+		if (!frame.queries.empty())
+			glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+
+		frame.queries.clear();
+		frame.queryCount = 0;
+		frame.resolved = true;
+	}
+
+	recording = false;
+}
+
+double Profiler::now() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+int Profiler::getFrameIndex(int age) const
+{
+	return (current - 1 - age + 2 * FRAME_HISTORY) % FRAME_HISTORY;
+}
+
+void Profiler::resolveQueries()
+{
+	// Oldest first, queries complete in order so the first frame that is not ready ends the search
+	for (int age = frameCount - 1; age >= 0; age--)
+	{
+		ProfileFrame &frame = frames[getFrameIndex(age)];
+		if (frame.resolved)
+			continue;
+
+		GLint available = 0;
+		glGetQueryObjectiv(frame.queries[frame.queryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		frame.gpuTime = 0.0f;
+
+		for (ProfileZone &zone : frame.zones)
+		{
+			if (zone.query < 0)
+				continue;
+
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(frame.queries[zone.query], GL_QUERY_RESULT, &nanoseconds);
+
+			zone.gpuTime = (float)(nanoseconds / 1e6);
+			frame.gpuTime += zone.gpuTime;
+		}
+
+		frame.resolved = true;
+	}
+}
+
+void Profiler::beginFrame()
+{
+	double time = now();
+
+	if (recording)
+	{
+		// Zones left open, e.g. by leaving the loop early, end with the frame
+		while (depth > 0)
+			popZone();
+
+		ProfileFrame &frame = frames[current];
+		frame.cpuTime = (float)(time - frame.startTime);
+		frame.resolved = frame.queryCount == 0;
+
+		current = (current + 1) % FRAME_HISTORY;
+
+		// One slot is always the frame being recorded
+		if (frameCount < FRAME_HISTORY - 1)
+			frameCount++;
+	}
+
+	resolveQueries();
+
+	recording = enabled;
+	if (!recording)
+		return;
+
+	ProfileFrame &frame = frames[current];
+
+	// Clearing keeps the capacity, after the first lap through the history nothing is allocated
+	frame.zones.clear();
+	frame.queryCount = 0;
+	frame.startTime = time;
+	frame.cpuTime = 0.0f;
+	frame.gpuTime = -1.0f;
+	frame.resolved = false;
+}
+
+void Profiler::pushZone(const char *name, bool gpu)
+{
+	if (!recording)
+		return;
+
+	if (depth >= MAX_DEPTH)
+	{
+		depth++;
+		return;
+	}
+
+	ProfileFrame &frame = frames[current];
+
+	ProfileZone zone;
+	zone.name = name;
+	zone.depth = depth;
+	zone.start = now() - frame.startTime;
+	zone.end = zone.start;
+	zone.query = -1;
+	zone.gpuTime = -1.0f;
+
+	if (gpu && !gpuZoneOpen)
+	{
+		if (frame.queryCount == (int)frame.queries.size())
+		{
+			GLuint query;
+			glGenQueries(1, &query);
+			frame.queries.push_back(query);
+		}
+
+		zone.query = frame.queryCount++;
+		gpuZoneOpen = true;
+
+		glBeginQuery(GL_TIME_ELAPSED, frame.queries[zone.query]);
+	}
+
+	stack[depth++] = (int)frame.zones.size();
+	frame.zones.push_back(zone);
+}
+
+void Profiler::popZone()
+{
+	if (!recording || depth == 0)
+		return;
+
+	depth--;
+	if (depth >= MAX_DEPTH)
+		return;
+
+	ProfileZone &zone = frames[current].zones[stack[depth]];
+	zone.end = now() - frames[current].startTime;
+
+	if (zone.query >= 0)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		gpuZoneOpen = false;
+	}
+}
+
+const ProfileFrame *Profiler::getLatestFrame() const
+{
+	for (int age = 0; age < frameCount; age++)
+	{
+		const ProfileFrame &frame = frames[getFrameIndex(age)];
+		if (frame.resolved)
+			return &frame;
+	}
+
+	return NULL;
+}
+
+bool Profiler::exportChromeTrace(const char *path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+		return false;
+
+	char event[256];
+
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+	// Chrome wants microseconds
+	for (int age = frameCount - 1; age >= 0; age--)
+	{
+		const ProfileFrame &frame = frames[getFrameIndex(age)];
+		double frameStart = frame.startTime * 1000.0;
+
+		snprintf(event, sizeof(event), ",\n{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			frameStart, frame.cpuTime * 1000.0);
+		file << event;
+
+		for (const ProfileZone &zone : frame.zones)
+		{
+			snprintf(event, sizeof(event), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+				zone.name, frameStart + zone.start * 1000.0, (zone.end - zone.start) * 1000.0);
+			file << event;
+
+			// Timer queries only give a duration, the GPU zone is placed where it was submitted
+			if (zone.gpuTime >= 0.0f)
+			{
+				snprintf(event, sizeof(event), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+					zone.name, frameStart + zone.start * 1000.0, zone.gpuTime * 1000.0);
+				file << event;
+			}
+		}
+	}
+
+	file << "\n]}\n";
+
+	return file.good();
+}
+
+static ImU32 getZoneColor(const char *name)
+{
+	uint64_t hash = hashBytes(name, strlen(name));
+	float hue = (float)(hash & 0xffff) / 65535.0f;
+
+	return ImColor::HSV(hue, 0.45f, 0.75f);
+}
+
+static void drawFlameGraph(const ProfileFrame &frame)
+{
+	int maxDepth = 0;
+	for (const ProfileZone &zone : frame.zones)
+		maxDepth = ImMax(maxDepth, zone.depth);
+
+	float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+	float width = ImGui::GetContentRegionAvail().x;
+
+	ImVec2 origin = ImGui::GetCursorScreenPos();
+	ImGui::InvisibleButton("##Flame", ImVec2(width, rowHeight * (maxDepth + 1)));
+
+	bool hovered = ImGui::IsItemHovered();
+	float scale = (frame.cpuTime > 0.0f) ? width / frame.cpuTime : 0.0f;
+
+	ImDrawList *drawList = ImGui::GetWindowDrawList();
+
+	for (const ProfileZone &zone : frame.zones)
+	{
+		ImVec2 min(origin.x + (float)zone.start * scale, origin.y + zone.depth * rowHeight);
+		ImVec2 max(origin.x + (float)zone.end * scale, min.y + rowHeight - 1.0f);
+
+		// Keep very short zones visible
+		max.x = ImMax(max.x, min.x + 1.0f);
+
+		drawList->AddRectFilled(min, max, getZoneColor(zone.name));
+
+		drawList->PushClipRect(min, max, true);
+		drawList->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_BLACK, zone.name);
+		drawList->PopClipRect();
+
+		if (hovered && ImGui::IsMouseHoveringRect(min, max))
+		{
+			if (zone.gpuTime >= 0.0f)
+				ImGui::SetTooltip("%s\nCPU %.3f ms\nGPU %.3f ms", zone.name, zone.end - zone.start, zone.gpuTime);
+			else
+				ImGui::SetTooltip("%s\nCPU %.3f ms", zone.name, zone.end - zone.start);
+		}
+	}
+}
+
+void Profiler::drawWindow(bool *open)
+{
+	if (!ImGui::Begin("Profiler", open))
+	{
+		ImGui::End();
+		return;
+	}
+
+	static std::string exportMessage;
+
+	ImGui::Checkbox("Record", &enabled);
+	ImGui::SameLine();
+
+	if (ImGui::Button("Export Chrome trace"))
+	{
+		const char *path = "profile_trace.json";
+		exportMessage = exportChromeTrace(path) ? std::string("Saved ") + path : std::string("Could not write ") + path;
+	}
+
+	if (!exportMessage.empty())
+	{
+		ImGui::SameLine();
+		ImGui::TextUnformatted(exportMessage.c_str());
+	}
+
+	const ProfileFrame *latest = getLatestFrame();
+	if (!latest)
+	{
+		ImGui::TextDisabled("No frames recorded yet");
+		ImGui::End();
+		return;
+	}
+
+	if (latest->gpuTime >= 0.0f)
+		ImGui::Text("CPU %.2f ms | GPU %.2f ms", latest->cpuTime, latest->gpuTime);
+	else
+		ImGui::Text("CPU %.2f ms", latest->cpuTime);
+
+	// Oldest frame first, unresolved GPU times show up as zero
+	float cpuHistory[FRAME_HISTORY], gpuHistory[FRAME_HISTORY];
+	for (int i = 0; i < frameCount; i++)
+	{
+		const ProfileFrame &frame = frames[getFrameIndex(frameCount - 1 - i)];
+		cpuHistory[i] = frame.cpuTime;
+		gpuHistory[i] = ImMax(frame.gpuTime, 0.0f);
+	}
+
+	auto getter = [](void *data, int idx) { return ((float *)data)[idx]; };
+	ImVec2 plotSize(ImGui::GetContentRegionAvail().x, 60.0f);
+
+	ImGui::SeparatorText("History");
+	ImGui::PlotEx(ImGuiPlotType_Lines, "##CPU", getter, cpuHistory, frameCount, 0, "CPU (ms)", 0.0f, FLT_MAX, plotSize);
+	ImGui::PlotEx(ImGuiPlotType_Lines, "##GPU", getter, gpuHistory, frameCount, 0, "GPU (ms)", 0.0f, FLT_MAX, plotSize);
+
+	ImGui::SeparatorText("Last frame");
+	drawFlameGraph(*latest);
+
+	if (ImGui::BeginTable("Zones", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Zone");
+		ImGui::TableSetupColumn("CPU (ms)");
+		ImGui::TableSetupColumn("GPU (ms)");
+		ImGui::TableHeadersRow();
+
+		for (const ProfileZone &zone : latest->zones)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%*s%s", zone.depth * 2, "", zone.name);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", zone.end - zone.start);
+			ImGui::TableNextColumn();
+			if (zone.gpuTime >= 0.0f)
+				ImGui::Text("%.3f", zone.gpuTime);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
+}
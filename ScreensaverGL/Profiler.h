@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <glad/glad.h>
+
+struct ProfileZone
+{
+	const char *name;
+	int depth;
+
+	// Milliseconds since the start of the frame
+	double start, end;
+
+	// Index into the frame's queries, -1 when the zone is not timed on the GPU
+	int query;
+
+	// Milliseconds, negative until the query result is in
+	float gpuTime;
+};
+
+struct ProfileFrame
+{
+	std::vector<ProfileZone> zones;
+
+	// Timer query objects, reused every time this slot of the history is recorded again
+	std::vector<GLuint> queries;
+	int queryCount = 0;
+
+	// Milliseconds since the profiler was created
+	double startTime = 0.0;
+
+	float cpuTime = 0.0f;
+
+	// Sum of the GPU zones, negative when there are none or they are not resolved yet
+	float gpuTime = -1.0f;
+
+	bool resolved = true;
+};
+
+// Scoped CPU zones plus GPU time through GL_TIME_ELAPSED queries, main thread only.
+// Query results are read back a few frames late, whenever the driver has them, so measuring never stalls.
+// GL timer queries do not nest, so a GPU zone opened inside another one is only timed on the CPU.
+struct Profiler
+{
+private:
+	static constexpr int FRAME_HISTORY = 240;
+	static constexpr int MAX_DEPTH = 16;
+
+	ProfileFrame frames[FRAME_HISTORY];
+
+	// Slot being recorded, and how many finished frames are in the history
+	int current = 0;
+	int frameCount = 0;
+
+	// Open zones, as indices into the current frame
+	int stack[MAX_DEPTH];
+	int depth = 0;
+
+	bool gpuZoneOpen = false;
+	bool recording = false;
+
+	std::chrono::steady_clock::time_point epoch;
+
+	double now() const;
+
+	void resolveQueries();
+
+	int getFrameIndex(int age) const;
+
+public:
+	// Stops recording from the next frame on, the history stays
+	bool enabled = true;
+
+	Profiler();
+
+	// Delete the query objects, call before the GL context goes away.
+	void shutdown();
+
+	// Ends the previous frame, so the frame time includes the swap
+	void beginFrame();
+
+	void pushZone(const char *name, bool gpu = false);
+	void popZone();
+
+	// Newest frame with all of its GPU times in, NULL while there is none
+	const ProfileFrame *getLatestFrame() const;
+
+	// Write the history in the Chrome trace event format, GPU zones go on their own track.
+	bool exportChromeTrace(const char *path) const;
+
+	void drawWindow(bool *open);
+};
+
+extern Profiler Profile;
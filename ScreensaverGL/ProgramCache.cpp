@@ -0,0 +1,252 @@
+#include "ProgramCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "GLExt.h"
+#include "Hash.h"
+
+ProgramCache Programs;
+
+// Bumped whenever the file layout below changes
+static const uint32_t BINARY_MAGIC = 0x31424753; // "SGB1"
+
+struct BinaryHeader
+{
+	uint32_t magic;
+	uint32_t format;
+	uint32_t length;
+	uint32_t reserved;
+	uint64_t key;
+};
+
+static bool readFile(const char *path, std::string &out)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	out = stream.str();
+
+	return true;
+}
+
+static void makeDirectory(const char *path)
+{
+#ifdef _WIN32
+	_mkdir(path);
+#else
+	mkdir(path, 0755);
+#endif
+}
+
+std::string ProgramCache::getBinaryPath(uint64_t key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+
+	return cacheDir + "/" + name;
+}
+
+bool ProgramCache::loadBinary(ShaderProgram &program, uint64_t key)
+{
+	std::ifstream file(getBinaryPath(key), std::ios::binary);
+	if (!file)
+		return false;
+
+	BinaryHeader header;
+	if (!file.read((char *)&header, sizeof(header)))
+		return false;
+
+	if (header.magic != BINARY_MAGIC || header.key != key || header.length == 0)
+		return false;
+
+	std::vector<char> binary(header.length);
+	if (!file.read(binary.data(), header.length))
+		return false;
+
+	GLuint id = glCreateProgram();
+	GLExt.ProgramBinary(id, (GLenum)header.format, binary.data(), (GLsizei)header.length);
+
+	// Drivers reject binaries from other builds here rather than by format, that is the expected miss
+	GLint success;
+	glGetProgramiv(id, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glDeleteProgram(id);
+		return false;
+	}
+
+	program.id = id;
+	return true;
+}
+
+void ProgramCache::saveBinary(ShaderProgram &program, uint64_t key)
+{
+	GLint length = 0;
+	glGetProgramiv(program.id, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	GLExt.GetProgramBinary(program.id, length, &length, &format, binary.data());
+
+	makeDirectory(cacheDir.c_str());
+
+	std::ofstream file(getBinaryPath(key), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		printf("Could not write program cache to %s\n", cacheDir.c_str());
+		return;
+	}
+
+	BinaryHeader header = { BINARY_MAGIC, format, (uint32_t)length, 0, key };
+	file.write((const char *)&header, sizeof(header));
+	file.write(binary.data(), length);
+}
+
+bool ProgramCache::compile(ShaderProgram &program, const std::string &vertCode, const std::string &fragCode)
+{
+	const char *vertexShader = vertCode.c_str();
+	const char *fragShader = fragCode.c_str();
+
+	GLuint vertex, fragment;
+	int success;
+	char infoLog[512];
+
+	vertex = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertex, 1, &vertexShader, NULL);
+	glCompileShader(vertex);
+
+	glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(vertex, 512, NULL, infoLog);
+		printf("%s\n%s\n", program.vertFile.c_str(), infoLog);
+		glDeleteShader(vertex);
+		return false;
+	}
+
+	fragment = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragment, 1, &fragShader, NULL);
+	glCompileShader(fragment);
+
+	glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(fragment, 512, NULL, infoLog);
+		printf("%s\n%s\n", program.fragFile.c_str(), infoLog);
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		return false;
+	}
+
+	GLuint id = glCreateProgram();
+
+	// Has to be set before linking for the driver to keep the binary around
+	if (GLExt.programBinary)
+		GLExt.ProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	glAttachShader(id, vertex);
+	glAttachShader(id, fragment);
+	glLinkProgram(id);
+
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+
+	glGetProgramiv(id, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(id, 512, NULL, infoLog);
+		printf("Program link failed\n%s\n", infoLog);
+		glDeleteProgram(id);
+		return false;
+	}
+
+	program.id = id;
+	return true;
+}
+
+ShaderProgram *ProgramCache::get(const char *vertFile, const char *fragFile)
+{
+	for (auto &program : programs)
+	{
+		if (program->vertFile == vertFile && program->fragFile == fragFile)
+			return program.get();
+	}
+
+	programs.emplace_back(new ShaderProgram());
+	ShaderProgram &program = *programs.back();
+	program.vertFile = vertFile;
+	program.fragFile = fragFile;
+
+	std::string vertCode, fragCode;
+	if (!readFile(vertFile, vertCode) || !readFile(fragFile, fragCode))
+	{
+		printf("Failed to read shader files\n%s\n%s\n", vertFile, fragFile);
+		return &program;
+	}
+
+	if (driverString.empty())
+	{
+		const GLubyte *strings[] = {
+			glGetString(GL_VENDOR),
+			glGetString(GL_RENDERER),
+			glGetString(GL_VERSION),
+			glGetString(GL_SHADING_LANGUAGE_VERSION)
+		};
+
+		for (const GLubyte *str : strings)
+		{
+			driverString += str ? (const char *)str : "";
+			driverString += '\n';
+		}
+	}
+
+	// Length of the vertex source is mixed in so moving code between the two files changes the key
+	size_t vertLength = vertCode.size();
+	uint64_t key = hashBytes(driverString.data(), driverString.size());
+	key = hashBytes(&vertLength, sizeof(vertLength), key);
+	key = hashBytes(vertCode.data(), vertCode.size(), key);
+	key = hashBytes(fragCode.data(), fragCode.size(), key);
+
+	if (GLExt.programBinary && loadBinary(program, key))
+	{
+		binaryLoads++;
+	}
+	else if (compile(program, vertCode, fragCode))
+	{
+		sourceCompiles++;
+
+		if (GLExt.programBinary)
+			saveBinary(program, key);
+	}
+
+	if (program.id)
+		program.reflection.reflect(program.id);
+
+	return &program;
+}
+
+void ProgramCache::clear()
+{
+	for (auto &program : programs)
+	{
+		if (program->id)
+			glDeleteProgram(program->id);
+	}
+
+	programs.clear();
+
+	GLState.invalidate();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "GLState.h"
+
+// A linked program shared by every Shader built from the same pair of files.
+// The reflection lives here too, since uniform values belong to the program and not to whoever uses it.
+struct ShaderProgram
+{
+	std::string vertFile, fragFile;
+
+	// 0 when compiling or linking failed
+	GLuint id = 0;
+
+	ShaderReflection reflection;
+};
+
+// Links each vertex/fragment pair once per run, and keeps the linked binaries on disk between runs.
+// Binaries are keyed by a hash of both sources and the GL vendor, renderer and version strings, so a driver
+// update or an edited shader simply misses. Anything that does not load falls back to compiling from source.
+struct ProgramCache
+{
+private:
+	std::vector<std::unique_ptr<ShaderProgram>> programs;
+
+	std::string driverString;
+
+	std::string getBinaryPath(uint64_t key);
+
+	bool loadBinary(ShaderProgram &program, uint64_t key);
+	void saveBinary(ShaderProgram &program, uint64_t key);
+
+	bool compile(ShaderProgram &program, const std::string &vertCode, const std::string &fragCode);
+
+public:
+	// Relative to the working directory, created on first save
+	std::string cacheDir = "shader_cache";
+
+	unsigned binaryLoads = 0, sourceCompiles = 0;
+
+	// Returns the shared program for this pair of files, linking it on first use.
+	ShaderProgram *get(const char *vertFile, const char *fragFile);
+
+	// Delete every program, call before the GL context goes away.
+	void clear();
+};
+
+extern ProgramCache Programs;
@@ -0,0 +1,62 @@
+#include "RenderTarget.h"
+
+#include <cstdio>
+
+#include "GLState.h"
+
+RenderTarget::~RenderTarget()
+{
+	destroy();
+}
+
+bool RenderTarget::create(int width, int height)
+{
+	destroy();
+
+	this->width = width;
+	this->height = height;
+
+	glGenTextures(1, &color);
+	GLState.bindTexture(GL_TEXTURE_2D, color);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		printf("Render target %dx%d is incomplete, status 0x%x\n", width, height, status);
+		destroy();
+		return false;
+	}
+
+	return true;
+}
+
+void RenderTarget::destroy()
+{
+	if (framebuffer)
+		glDeleteFramebuffers(1, &framebuffer);
+
+	if (color)
+	{
+		GLState.forgetTexture(color);
+		glDeleteTextures(1, &color);
+	}
+
+	framebuffer = 0;
+	color = 0;
+}
+
+void RenderTarget::bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, width, height);
+}
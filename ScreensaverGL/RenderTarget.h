@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Offscreen color buffer to render into instead of the window, used by the headless mode.
+struct RenderTarget
+{
+private:
+	GLuint framebuffer = 0;
+	GLuint color = 0;
+
+	int width = 0, height = 0;
+
+public:
+	~RenderTarget();
+
+	// Returns false when the driver cannot render into an RGBA8 texture of this size.
+	bool create(int width, int height);
+
+	void destroy();
+
+	// Make this the target of every following draw, and set the viewport to cover it
+	void bind();
+
+	GLuint getFramebuffer() const { return framebuffer; }
+
+	GLuint getTexture() const { return color; }
+
+	int getWidth() const { return width; }
+
+	int getHeight() const { return height; }
+};
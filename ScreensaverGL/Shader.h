@@ -0,0 +1,232 @@
+#pragma once
+
+#include <string>
+
+#include <glad/glad.h>
+
+#include "imgui.h"
+
+#include <gtc/matrix_transform.hpp>
+#include <gtc/type_ptr.hpp>
+
+#include <stb_image.h>
+
+#include "GLState.h"
+#include "ProgramCache.h"
+
+typedef std::string String;
+
+struct Shader
+{
+protected:
+	static constexpr int VERT_LENGTH = 20;
+
+	float verts[VERT_LENGTH];
+	int indices[6] = {
+		0, 2, 3,
+		0, 1, 2
+	};
+
+	// Buffers
+	GLuint VAO, VBO, EBO;
+
+	// Box properties
+	GLuint programId = 0;
+	ShaderReflection *reflection = nullptr;
+
+	// Texture properties
+	GLuint texture = 0;
+	int txWidth, txHeight, txChannels;
+
+public:
+	ImVec4 color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+
+	void create(float size, ImVec4 color)
+	{
+		this->color = color;
+
+		float newVerts[VERT_LENGTH] = {
+			// Pos				// Texture coordinate
+			-size,  size, 0.0f,	0.0f, 1.0f,
+			 size,  size, 0.0f,	1.0f, 1.0f,
+			 size, -size, 0.0f,	1.0f, 0.0f,
+			-size, -size, 0.0f,	0.0f, 0.0f
+		};
+
+		for (int i = 0; i < VERT_LENGTH; i++)
+			verts[i] = newVerts[i];
+
+		glGenBuffers(1, &VBO);
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &EBO);
+	}
+
+	// Programs are shared between every shader built from the same files, see ProgramCache
+	void createShader(const char *vertFile, const char *fragFile)
+	{
+		ShaderProgram *program = Programs.get(vertFile, fragFile);
+
+		this->programId = program->id;
+		this->reflection = &program->reflection;
+	}
+
+	void createBufferData()
+	{
+		GLState.bindVertexArray(VAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(this->verts), this->verts, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(this->indices), this->indices, GL_STATIC_DRAW);
+
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (GLvoid *)0);
+		glEnableVertexAttribArray(0);
+
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (GLvoid *)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+	}
+
+	// Rebuild the quad around its center with a new half size, the texture coordinates stay.
+	void resizeQuad(float size)
+	{
+		float corners[4][2] = { { -size, size }, { size, size }, { size, -size }, { -size, -size } };
+
+		for (int i = 0; i < 4; i++)
+		{
+			verts[i * 5 + 0] = corners[i][0];
+			verts[i * 5 + 1] = corners[i][1];
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(this->verts), this->verts);
+	}
+
+	void createTexture(const char *txFile, GLint wrapS, GLint wrapT, GLint filterMin, GLint filterMag, GLenum fmt = GL_RGB)
+	{
+		glGenTextures(1, &this->texture);
+		GLState.bindTexture(GL_TEXTURE_2D, texture);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterMin);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMag);
+
+		stbi_set_flip_vertically_on_load(true);
+
+		unsigned char *data = stbi_load(txFile, &this->txWidth, &this->txHeight, &this->txChannels, 0);
+		if (!data)
+		{
+			printf("Failed to load texture file\nFile: %s\n", txFile);
+			return;
+		}
+
+		glTexImage2D(GL_TEXTURE_2D, 0, fmt, this->txWidth, this->txHeight, 0, fmt, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		stbi_image_free(data);
+	}
+
+	// Point the shader at a texture it does not own, pass 0 to draw without one.
+	// Whoever handed the previous texture out is responsible for releasing it.
+	void setTexture(GLuint texture, int width, int height)
+	{
+		this->texture = texture;
+		this->txWidth = width;
+		this->txHeight = height;
+	}
+
+	void deleteTexture()
+	{
+		GLState.forgetTexture(texture);
+		glDeleteTextures(1, &texture);
+
+		texture = 0;
+	}
+
+	void use()
+	{
+		GLState.useProgram(this->programId);
+	}
+
+	void setUniform(ShaderUniform uniform, const glm::mat4 &value)
+	{
+		this->use();
+
+		GLState.setUniform(*this->reflection, uniform, glm::value_ptr(value));
+	}
+
+	void draw()
+	{
+		this->use();
+
+		GLState.setUniform(*this->reflection, Uniform_UseTexture, hasTexture());
+		GLState.setUniform(*this->reflection, Uniform_Color, color.x, color.y, color.z, color.w);
+
+		if (hasTexture())
+			GLState.bindTexture(GL_TEXTURE_2D, this->texture);
+
+		GLState.bindVertexArray(VAO);
+		glDrawElements(GL_TRIANGLES, sizeof(this->indices) / sizeof(int), GL_UNSIGNED_INT, 0);
+		GLState.countDraw();
+	}
+
+	GLuint getVAO(GLuint id)
+	{
+		return this->VAO;
+	}
+
+	GLuint getVBO(GLuint id)
+	{
+		return this->VBO;
+	}
+
+	GLuint getEBO(GLuint id)
+	{
+		return this->EBO;
+	}
+
+	GLuint getProgramID()
+	{
+		return this->programId;
+	}
+
+	const ShaderReflection &getReflection()
+	{
+		return *this->reflection;
+	}
+
+	GLuint getTexture()
+	{
+		return this->texture;
+	}
+
+	int getTextureWidth()
+	{
+		return this->txWidth;
+	}
+
+	int getTextureHeight()
+	{
+		return this->txHeight;
+	}
+
+	bool hasTexture()
+	{
+		return (texture != 0) ? true : false;
+	}
+};
+
+struct Box : public Shader
+{
+	glm::mat4 model = glm::mat4(1.0f);
+
+	glm::vec3 pos = glm::vec3(0.0f);
+
+	Box(const char *vf, const char *ff, float size, ImVec4 color)
+	{
+		create(size, color);
+		createShader(vf, ff);
+		createBufferData();
+	}
+};
@@ -0,0 +1,220 @@
+#include "Simulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIM_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC lets any intrinsic through, GCC and Clang need the function to be compiled for AVX2.
+#if defined(SIM_X86) && !defined(_MSC_VER)
+#define SIM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SIM_TARGET_AVX2
+#endif
+
+// Every kernel does the same thing per entity, without branches:
+//   p += v * dt
+//   if p > hi: p = 2 * hi - p, v = -|v|
+//   if p < lo: p = 2 * lo - p, v =  |v|
+//   p = clamp(p, lo, hi)
+// Forcing the sign of v instead of flipping it keeps entities that start outside the bounds from getting stuck.
+
+static void stepAxisScalar(float *pos, float *vel, size_t begin, size_t end, float dt, float lo, float hi)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		float p = pos[i] + vel[i] * dt;
+		float speed = std::fabs(vel[i]);
+
+		bool over = p > hi;
+		bool under = p < lo;
+
+		p = over ? 2.0f * hi - p : (under ? 2.0f * lo - p : p);
+
+		vel[i] = over ? -speed : (under ? speed : vel[i]);
+		pos[i] = std::min(std::max(p, lo), hi);
+	}
+}
+
+#ifdef SIM_X86
+static size_t stepAxisSSE2(float *pos, float *vel, size_t begin, size_t end, float dt, float lo, float hi)
+{
+	const __m128 vdt = _mm_set1_ps(dt);
+	const __m128 vlo = _mm_set1_ps(lo);
+	const __m128 vhi = _mm_set1_ps(hi);
+	const __m128 sign = _mm_set1_ps(-0.0f);
+
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 v = _mm_loadu_ps(vel + i);
+		__m128 p = _mm_add_ps(_mm_loadu_ps(pos + i), _mm_mul_ps(v, vdt));
+
+		__m128 over = _mm_cmpgt_ps(p, vhi);
+		__m128 under = _mm_cmplt_ps(p, vlo);
+		__m128 hit = _mm_or_ps(over, under);
+
+		__m128 limit = _mm_or_ps(_mm_and_ps(over, vhi), _mm_and_ps(under, vlo));
+		__m128 reflected = _mm_sub_ps(_mm_add_ps(limit, limit), p);
+		p = _mm_or_ps(_mm_and_ps(hit, reflected), _mm_andnot_ps(hit, p));
+		p = _mm_min_ps(_mm_max_ps(p, vlo), vhi);
+
+		__m128 speed = _mm_andnot_ps(sign, v);
+		v = _mm_or_ps(_mm_andnot_ps(hit, v), _mm_and_ps(hit, speed));
+		v = _mm_or_ps(v, _mm_and_ps(over, sign));
+
+		_mm_storeu_ps(pos + i, p);
+		_mm_storeu_ps(vel + i, v);
+	}
+
+	return i;
+}
+
+SIM_TARGET_AVX2
+static size_t stepAxisAVX2(float *pos, float *vel, size_t begin, size_t end, float dt, float lo, float hi)
+{
+	const __m256 vdt = _mm256_set1_ps(dt);
+	const __m256 vlo = _mm256_set1_ps(lo);
+	const __m256 vhi = _mm256_set1_ps(hi);
+	const __m256 sign = _mm256_set1_ps(-0.0f);
+
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 v = _mm256_loadu_ps(vel + i);
+		__m256 p = _mm256_add_ps(_mm256_loadu_ps(pos + i), _mm256_mul_ps(v, vdt));
+
+		__m256 over = _mm256_cmp_ps(p, vhi, _CMP_GT_OQ);
+		__m256 under = _mm256_cmp_ps(p, vlo, _CMP_LT_OQ);
+		__m256 hit = _mm256_or_ps(over, under);
+
+		__m256 limit = _mm256_blendv_ps(vlo, vhi, over);
+		__m256 reflected = _mm256_sub_ps(_mm256_add_ps(limit, limit), p);
+		p = _mm256_blendv_ps(p, reflected, hit);
+		p = _mm256_min_ps(_mm256_max_ps(p, vlo), vhi);
+
+		__m256 speed = _mm256_andnot_ps(sign, v);
+		v = _mm256_blendv_ps(v, speed, hit);
+		v = _mm256_or_ps(v, _mm256_and_ps(over, sign));
+
+		_mm256_storeu_ps(pos + i, p);
+		_mm256_storeu_ps(vel + i, v);
+	}
+
+	return i;
+}
+#endif
+
+static SimKernel detectSimKernel()
+{
+#ifdef SIM_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+
+	bool avx2 = false;
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+
+	// The OS has to save the YMM registers on context switch as well
+	if (osxsave && avx && avx2 && (_xgetbv(0) & 0x6) == 0x6)
+		return SimKernel_AVX2;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return SimKernel_AVX2;
+#endif
+	return SimKernel_SSE2;
+#else
+	return SimKernel_Scalar;
+#endif
+}
+
+SimKernel getSimKernel()
+{
+	static const SimKernel kernel = detectSimKernel();
+	return kernel;
+}
+
+const char *getSimKernelName(SimKernel kernel)
+{
+	switch (kernel)
+	{
+	case SimKernel_AVX2:	return "AVX2";
+	case SimKernel_SSE2:	return "SSE2";
+	default:				return "Scalar";
+	}
+}
+
+static void stepAxis(float *pos, float *vel, size_t begin, size_t end, float dt, float lo, float hi)
+{
+	size_t i = begin;
+
+#ifdef SIM_X86
+	switch (getSimKernel())
+	{
+	case SimKernel_AVX2:
+		i = stepAxisAVX2(pos, vel, i, end, dt, lo, hi);
+		break;
+	case SimKernel_SSE2:
+		i = stepAxisSSE2(pos, vel, i, end, dt, lo, hi);
+		break;
+	default:
+		break;
+	}
+#endif
+
+	// Tail that does not fill a whole register
+	stepAxisScalar(pos, vel, i, end, dt, lo, hi);
+}
+
+void BounceSim::resize(size_t count)
+{
+	posX.resize(count, 0.0f);
+	posY.resize(count, 0.0f);
+	velX.resize(count, 0.0f);
+	velY.resize(count, 0.0f);
+	prevX.resize(count, 0.0f);
+	prevY.resize(count, 0.0f);
+}
+
+void BounceSim::savePrevious(size_t begin, size_t end)
+{
+	std::copy(posX.begin() + begin, posX.begin() + end, prevX.begin() + begin);
+	std::copy(posY.begin() + begin, posY.begin() + end, prevY.begin() + begin);
+}
+
+void BounceSim::teleport(size_t i, float x, float y)
+{
+	posX[i] = prevX[i] = x;
+	posY[i] = prevY[i] = y;
+}
+
+void BounceSim::step(float dt)
+{
+	step(dt, 0, size());
+}
+
+void BounceSim::step(float dt, size_t begin, size_t end)
+{
+	end = std::min(end, size());
+	if (begin >= end)
+		return;
+
+	stepAxis(posX.data(), velX.data(), begin, end, dt, bounds.minX, bounds.maxX);
+	stepAxis(posY.data(), velY.data(), begin, end, dt, bounds.minY, bounds.maxY);
+}
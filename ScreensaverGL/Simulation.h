@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Limits the entities bounce between, in normalized device coordinates.
+struct SimBounds
+{
+	float minX, maxX;
+	float minY, maxY;
+};
+
+enum SimKernel
+{
+	SimKernel_Scalar,
+	SimKernel_SSE2,
+	SimKernel_AVX2
+};
+
+// Bounce simulation stored as structure-of-arrays, so every axis can be stepped
+// with wide SIMD loads instead of one glm::vec3 at a time.
+struct BounceSim
+{
+	std::vector<float> posX, posY;
+	std::vector<float> velX, velY;
+
+	// Positions before the latest step, rendering interpolates from here
+	std::vector<float> prevX, prevY;
+
+	SimBounds bounds = { -0.8f, 0.8f, -0.8f, 0.75f };
+
+	void resize(size_t count);
+
+	size_t size() const { return posX.size(); }
+
+	// Move every entity by its velocity and reflect it off the bounds.
+	void step(float dt);
+
+	// Same as step(dt) but only touches entities in [begin, end).
+	void step(float dt, size_t begin, size_t end);
+
+	// Copy the current positions in [begin, end) to prevX/prevY, call before the last step of a frame.
+	void savePrevious(size_t begin, size_t end);
+
+	// Move an entity without it being interpolated across the jump
+	void teleport(size_t i, float x, float y);
+
+	float getX(size_t i, float alpha) const { return prevX[i] + (posX[i] - prevX[i]) * alpha; }
+	float getY(size_t i, float alpha) const { return prevY[i] + (posY[i] - prevY[i]) * alpha; }
+};
+
+// The widest kernel this CPU supports, picked once at startup.
+SimKernel getSimKernel();
+
+const char *getSimKernelName(SimKernel kernel);
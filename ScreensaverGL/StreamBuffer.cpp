@@ -0,0 +1,197 @@
+#include "StreamBuffer.h"
+
+#include <cstddef>
+
+#include "GLExt.h"
+
+StreamBuffer::~StreamBuffer()
+{
+	destroy();
+}
+
+void StreamBuffer::create(GLsizeiptr regionSize)
+{
+	destroy();
+
+	this->regionSize = regionSize;
+	createStorage();
+}
+
+void StreamBuffer::destroy()
+{
+	if (buffer)
+		destroyStorage();
+
+	regionSize = 0;
+}
+
+void StreamBuffer::createStorage()
+{
+	GLsizeiptr size = regionSize * STREAM_REGIONS;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+	if (GLExt.bufferStorage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		GLExt.BufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+		mapped = (unsigned char *)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+
+		// Immutable storage cannot be respecified, start over with a plain buffer
+		if (!mapped)
+		{
+			glDeleteBuffers(1, &buffer);
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		}
+	}
+
+	if (!mapped)
+		glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STREAM_DRAW);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	region = 0;
+	head = 0;
+}
+
+void StreamBuffer::destroyStorage()
+{
+	if (mapped || pendingUnmap)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	for (GLsync &fence : fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+
+		fence = 0;
+	}
+
+	// Draws already queued keep the old storage alive until they are done
+	glDeleteBuffers(1, &buffer);
+
+	buffer = 0;
+	mapped = nullptr;
+	pendingUnmap = false;
+}
+
+void StreamBuffer::waitRegion(int index)
+{
+	GLsync &fence = fences[index];
+	if (!fence)
+		return;
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		stalls++;
+
+		do
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	glDeleteSync(fence);
+	fence = 0;
+}
+
+void StreamBuffer::beginFrame()
+{
+	if (!buffer)
+		return;
+
+	head = 0;
+
+	if (mapped)
+	{
+		region = (region + 1) % STREAM_REGIONS;
+		waitRegion(region);
+	}
+	else
+	{
+		// The driver hands out fresh storage while the GPU keeps reading the old one
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, regionSize * STREAM_REGIONS, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+}
+
+void *StreamBuffer::allocate(GLsizeiptr bytes, GLsizeiptr alignment, GLintptr &offset)
+{
+	commit();
+
+	// Align the offset from the start of the buffer, regions do not have to be a multiple of the alignment
+	GLintptr base = (GLintptr)region * regionSize;
+	GLsizeiptr start = (base + head + alignment - 1) / alignment * alignment - base;
+
+	if (!buffer || start + bytes > regionSize)
+	{
+		GLsizeiptr size = (regionSize > 0) ? regionSize : 64 * 1024;
+		while (size < bytes)
+			size *= 2;
+
+		if (buffer)
+		{
+			size *= 2;
+			grows++;
+
+			destroyStorage();
+		}
+
+		regionSize = size;
+		createStorage();
+
+		// New storage starts over in the first region
+		base = 0;
+		start = 0;
+	}
+
+	head = start + bytes;
+
+	// The orphaning path only ever uses the first region
+	offset = base + start;
+
+	if (mapped)
+		return mapped + offset;
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	void *data = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	pendingUnmap = data != nullptr;
+
+	return data;
+}
+
+void StreamBuffer::commit()
+{
+	// Coherent mappings are visible to every command issued after the write
+	if (!pendingUnmap)
+		return;
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	pendingUnmap = false;
+}
+
+void StreamBuffer::endFrame()
+{
+	commit();
+
+	if (!mapped)
+		return;
+
+	if (fences[region])
+		glDeleteSync(fences[region]);
+
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Buffer for data that is rewritten every frame, like UI vertices or instance data.
+// It holds STREAM_REGIONS regions and every frame writes into the next one. The region is fenced once the
+// frame's draws are queued, so the CPU only waits when it gets a whole ring ahead of the GPU.
+// With buffer storage the buffer is mapped once, persistently and coherently, otherwise every frame
+// orphans the storage and maps the ranges it writes unsynchronized.
+// Storage is managed through GL_COPY_WRITE_BUFFER, so bindings that belong to a VAO are never touched.
+struct StreamBuffer
+{
+private:
+	static constexpr int STREAM_REGIONS = 3;
+
+	GLuint buffer = 0;
+	GLsizeiptr regionSize = 0;
+
+	unsigned char *mapped = nullptr;
+
+	GLsync fences[STREAM_REGIONS] = {};
+	int region = 0;
+
+	// Write position inside the current region
+	GLsizeiptr head = 0;
+
+	// Orphaning path only, the range handed out by the last allocate() is still mapped
+	bool pendingUnmap = false;
+
+	void createStorage();
+	void destroyStorage();
+
+	void waitRegion(int index);
+
+public:
+	// Frames that had to wait for the GPU, and how often the regions were too small
+	unsigned stalls = 0;
+	unsigned grows = 0;
+
+	~StreamBuffer();
+
+	void create(GLsizeiptr regionSize);
+
+	void destroy();
+
+	// Move on to the next region, waiting for the GPU to be done with it.
+	void beginFrame();
+
+	// Reserve bytes at an aligned offset from the start of getBuffer(), the alignment does not have to be
+	// a power of two. Grows every region when this one is full, which replaces the buffer, so draw from
+	// one allocation before making the next. bytes has to be more than 0.
+	// The pointer stays valid until commit(), NULL when the driver could not map the range.
+	void *allocate(GLsizeiptr bytes, GLsizeiptr alignment, GLintptr &offset);
+
+	// Hand the data written since allocate() to GL, call before drawing from it.
+	void commit();
+
+	// Fence this frame's region, call after the last draw that reads from it.
+	void endFrame();
+
+	GLuint getBuffer() const { return buffer; }
+
+	GLsizeiptr getRegionSize() const { return regionSize; }
+
+	bool isPersistent() const { return mapped != nullptr; }
+};
@@ -0,0 +1,18 @@
+#version 330 core
+
+in vec2 texCoord;
+in vec4 color;
+flat in float layer;
+
+out vec4 fragColor;
+
+uniform sampler2DArray uTexture;
+uniform bool uUseTexture = false;
+
+void main()
+{
+	if (uUseTexture)
+		fragColor = texture(uTexture, vec3(texCoord, layer)) * color;
+	else
+		fragColor = color;
+}
\ No newline at end of file
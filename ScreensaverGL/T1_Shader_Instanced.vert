@@ -0,0 +1,21 @@
+#version 330 core
+
+layout (location = 0) in vec3 iPos;
+layout (location = 1) in vec2 iTexCoord;
+
+// Per-instance attributes
+layout (location = 2) in vec3 iOffset;
+layout (location = 3) in vec4 iColor;
+layout (location = 4) in float iLayer;
+
+out vec2 texCoord;
+out vec4 color;
+flat out float layer;
+
+void main()
+{
+	gl_Position = vec4(iPos + iOffset, 1.0);
+	texCoord = iTexCoord;
+	color = iColor;
+	layer = iLayer;
+}
\ No newline at end of file
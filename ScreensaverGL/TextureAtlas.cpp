@@ -0,0 +1,125 @@
+#include "TextureAtlas.h"
+
+#include <cstdio>
+
+#include "GLState.h"
+
+TextureAtlas::TextureAtlas(int layerSize)
+	: layerSize(layerSize)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	if (texture)
+	{
+		GLState.forgetTexture(texture);
+		glDeleteTextures(1, &texture);
+	}
+
+	if (readFBO)
+	{
+		glDeleteFramebuffers(1, &readFBO);
+		glDeleteFramebuffers(1, &drawFBO);
+	}
+}
+
+void TextureAtlas::allocate(int newCapacity)
+{
+	GLuint newTexture;
+	glGenTextures(1, &newTexture);
+
+	GLState.bindTexture(GL_TEXTURE_2D_ARRAY, newTexture);
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, layerSize, layerSize, newCapacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+	GLuint oldTexture = texture;
+	texture = newTexture;
+	capacity = newCapacity;
+
+	if (oldTexture)
+	{
+		for (int i = 0; i < count; i++)
+			blit(oldTexture, i, layerSize, layerSize, i);
+
+		GLState.forgetTexture(oldTexture);
+		glDeleteTextures(1, &oldTexture);
+	}
+}
+
+void TextureAtlas::blit(GLuint source, int sourceLayer, int width, int height, int destLayer)
+{
+	if (!readFBO)
+	{
+		glGenFramebuffers(1, &readFBO);
+		glGenFramebuffers(1, &drawFBO);
+	}
+
+	GLint oldRead, oldDraw;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &oldRead);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldDraw);
+
+	GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+	if (scissor)
+		glDisable(GL_SCISSOR_TEST);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+	if (sourceLayer < 0)
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source, 0);
+	else
+		glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, source, 0, sourceLayer);
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFBO);
+	glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, destLayer);
+
+	if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE &&
+		glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
+	{
+		glBlitFramebuffer(0, 0, width, height, 0, 0, layerSize, layerSize, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	}
+	else
+	{
+		printf("Texture atlas blit failed, layer %d\n", destLayer);
+	}
+
+	// Detach so the FBOs do not keep deleted textures alive
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+	glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 0, 0, 0);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, oldRead);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldDraw);
+
+	if (scissor)
+		glEnable(GL_SCISSOR_TEST);
+}
+
+int TextureAtlas::addLayer(GLuint source, int width, int height)
+{
+	if (count == capacity)
+	{
+		GLint maxLayers;
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+		if (capacity >= maxLayers)
+			return -1;
+
+		int newCapacity = (capacity == 0) ? 16 : capacity * 2;
+		if (newCapacity > maxLayers)
+			newCapacity = maxLayers;
+
+		allocate(newCapacity);
+	}
+
+	int layer = count++;
+	blit(source, -1, width, height, layer);
+
+	GLState.bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+	return layer;
+}
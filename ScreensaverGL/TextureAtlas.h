@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Many logos packed into the layers of one GL_TEXTURE_2D_ARRAY, so a whole swarm needs one bind and one draw.
+// Sources of any size are scaled into square layers on the GPU with a framebuffer blit, boxes stretch
+// their texture over the quad anyway. The array doubles its layer count when it runs full.
+struct TextureAtlas
+{
+private:
+	GLuint texture = 0;
+	GLuint readFBO = 0, drawFBO = 0;
+
+	int layerSize;
+	int capacity = 0;
+	int count = 0;
+
+	void allocate(int newCapacity);
+
+	// Blit into a layer of the array, source is either a 2D texture or a layer of another array.
+	void blit(GLuint source, int sourceLayer, int width, int height, int destLayer);
+
+public:
+	explicit TextureAtlas(int layerSize = 256);
+	~TextureAtlas();
+
+	// Copy a 2D texture into a new layer, returns its index or -1 when the GL limit is reached.
+	// The source can be released afterwards.
+	int addLayer(GLuint source, int width, int height);
+
+	void clear() { count = 0; }
+
+	GLuint getTexture() const { return texture; }
+
+	int getLayerCount() const { return count; }
+
+	int getLayerSize() const { return layerSize; }
+};
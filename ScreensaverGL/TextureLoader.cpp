@@ -0,0 +1,330 @@
+#include "TextureLoader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <stb_image.h>
+
+#include "GLExt.h"
+#include "GLState.h"
+
+TextureLoader::TextureLoader(JobSystem &jobs)
+	: jobs(jobs)
+{
+	// Global in stb_image, set once here so the workers never race on it
+	stbi_set_flip_vertically_on_load(true);
+}
+
+TextureLoader::~TextureLoader()
+{
+	decodeFence.wait();
+
+	for (std::unique_ptr<Load> &load : loads)
+	{
+		if (load->pixels)
+			stbi_image_free(load->pixels);
+
+		if (load->texture)
+		{
+			GLState.forgetTexture(load->texture);
+			glDeleteTextures(1, &load->texture);
+		}
+	}
+
+	for (GLsync &fence : slotFences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+	}
+
+	if (pbo)
+	{
+		if (mapped)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+
+		glDeleteBuffers(1, &pbo);
+	}
+}
+
+void TextureLoader::decode(void *data, size_t begin, size_t end)
+{
+	Load *load = (Load *)data;
+
+	int channels = (load->params.format == GL_RGBA) ? 4 : 3;
+
+	if (load->fileData.empty())
+	{
+		load->pixels = stbi_load(load->path.c_str(), &load->width, &load->height, &load->channels, channels);
+	}
+	else
+	{
+		load->pixels = stbi_load_from_memory(load->fileData.data(), (int)load->fileData.size(),
+			&load->width, &load->height, &load->channels, channels);
+
+		std::vector<unsigned char>().swap(load->fileData);
+	}
+
+	if (!load->pixels)
+	{
+		printf("Failed to load texture file\nFile: %s\n", load->path.c_str());
+		load->state.store(Load_Failed, std::memory_order_release);
+		return;
+	}
+
+	// stbi reports the channels of the file, the buffer has the ones we asked for
+	load->channels = channels;
+	load->state.store(Load_Decoded, std::memory_order_release);
+}
+
+int TextureLoader::request(const char *path, const TextureParams &params)
+{
+	std::unique_ptr<Load> load(new Load());
+	load->path = path;
+	load->params = params;
+
+	return submit(std::move(load));
+}
+
+int TextureLoader::request(std::vector<unsigned char> &&fileData, const char *name, const TextureParams &params)
+{
+	std::unique_ptr<Load> load(new Load());
+	load->path = name;
+	load->params = params;
+	load->fileData = std::move(fileData);
+
+	return submit(std::move(load));
+}
+
+int TextureLoader::submit(std::unique_ptr<Load> load)
+{
+	load->id = nextId++;
+
+	Job job;
+	job.func = decode;
+	job.data = load.get();
+	job.begin = 0;
+	job.end = 1;
+	job.fence = &decodeFence;
+
+	loads.push_back(std::move(load));
+
+	decodeFence.add(1);
+	jobs.submit(job);
+
+	return loads.back()->id;
+}
+
+void TextureLoader::createStaging()
+{
+	glGenBuffers(1, &pbo);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+
+	if (GLExt.bufferStorage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		GLExt.BufferStorage(GL_PIXEL_UNPACK_BUFFER, STAGING_SLOT_SIZE * STAGING_SLOTS, NULL, flags);
+		mapped = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, STAGING_SLOT_SIZE * STAGING_SLOTS, flags);
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+bool TextureLoader::uploadChunk(Load &load)
+{
+	GLsizeiptr rowBytes = (GLsizeiptr)load.width * load.channels;
+	int rows = (int)(STAGING_SLOT_SIZE / rowBytes);
+	if (rows > load.height - load.rowsUploaded)
+		rows = load.height - load.rowsUploaded;
+
+	GLsizeiptr bytes = rowBytes * rows;
+	GLintptr offset = 0;
+	unsigned char *dst;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+
+	if (mapped)
+	{
+		// The slot is still being read by an earlier upload, try again next frame
+		GLsync &fence = slotFences[nextSlot];
+		if (fence)
+		{
+			if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			{
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				return false;
+			}
+
+			glDeleteSync(fence);
+			fence = 0;
+		}
+
+		offset = nextSlot * STAGING_SLOT_SIZE;
+		dst = mapped + offset;
+	}
+	else
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, STAGING_SLOT_SIZE, NULL, GL_STREAM_DRAW);
+		dst = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (!dst)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return false;
+		}
+	}
+
+	memcpy(dst, load.pixels + rowBytes * load.rowsUploaded, bytes);
+	GLState.countUpload(bytes);
+
+	if (!mapped)
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	GLenum fmt = (load.channels == 4) ? GL_RGBA : GL_RGB;
+
+	GLState.bindTexture(GL_TEXTURE_2D, load.texture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, load.rowsUploaded, load.width, rows, fmt, GL_UNSIGNED_BYTE, (GLvoid *)offset);
+
+	if (mapped)
+	{
+		slotFences[nextSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		nextSlot = (nextSlot + 1) % STAGING_SLOTS;
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	load.rowsUploaded += rows;
+
+	return true;
+}
+
+void TextureLoader::update()
+{
+	if (loads.empty())
+		return;
+
+	if (!pbo)
+		createStaging();
+
+	auto start = std::chrono::steady_clock::now();
+	auto elapsedMs = [start]() {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	// Rows of RGB images are not 4 byte aligned
+	GLint oldAlignment;
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &oldAlignment);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	bool stalled = false;
+	for (std::unique_ptr<Load> &load : loads)
+	{
+		int state = load->state.load(std::memory_order_acquire);
+
+		if (state == Load_Decoded)
+		{
+			if ((GLsizeiptr)load->width * load->channels > STAGING_SLOT_SIZE)
+			{
+				printf("Texture too wide to stage\nFile: %s\n", load->path.c_str());
+				stbi_image_free(load->pixels);
+				load->pixels = nullptr;
+				load->state = Load_Failed;
+				continue;
+			}
+
+			GLenum fmt = (load->channels == 4) ? GL_RGBA : GL_RGB;
+
+			glGenTextures(1, &load->texture);
+			GLState.bindTexture(GL_TEXTURE_2D, load->texture);
+
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, load->params.wrapS);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, load->params.wrapT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, load->params.filterMin);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, load->params.filterMag);
+
+			// Allocate only, the pixels come in through the staging buffer
+			glTexImage2D(GL_TEXTURE_2D, 0, fmt, load->width, load->height, 0, fmt, GL_UNSIGNED_BYTE, NULL);
+
+			state = Load_Uploading;
+			load->state = state;
+		}
+
+		if (state != Load_Uploading)
+			continue;
+
+		// Always make some progress, even with a tiny budget
+		while (!stalled && load->rowsUploaded < load->height)
+		{
+			if (!uploadChunk(*load))
+				stalled = true;
+
+			if (elapsedMs() >= budgetMs)
+				break;
+		}
+
+		if (load->rowsUploaded == load->height)
+		{
+			GLState.bindTexture(GL_TEXTURE_2D, load->texture);
+			glGenerateMipmap(GL_TEXTURE_2D);
+
+			stbi_image_free(load->pixels);
+			load->pixels = nullptr;
+			load->state = Load_Resident;
+		}
+
+		if (stalled || elapsedMs() >= budgetMs)
+			break;
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, oldAlignment);
+}
+
+TextureLoader::Load *TextureLoader::find(int id)
+{
+	for (std::unique_ptr<Load> &load : loads)
+	{
+		if (load->id == id)
+			return load.get();
+	}
+
+	return nullptr;
+}
+
+TextureLoadResult TextureLoader::take(int id, GLuint &texture, int &width, int &height)
+{
+	Load *load = find(id);
+	if (!load)
+		return TextureLoad_Failed;
+
+	int state = load->state.load(std::memory_order_acquire);
+	if (state != Load_Resident && state != Load_Failed)
+		return TextureLoad_Pending;
+
+	texture = load->texture;
+	width = load->width;
+	height = load->height;
+
+	for (size_t i = 0; i < loads.size(); i++)
+	{
+		if (loads[i].get() == load)
+		{
+			loads.erase(loads.begin() + i);
+			break;
+		}
+	}
+
+	return (state == Load_Resident) ? TextureLoad_Ready : TextureLoad_Failed;
+}
+
+float TextureLoader::getProgress(int id)
+{
+	Load *load = find(id);
+	if (!load || load->state.load(std::memory_order_acquire) < Load_Uploading)
+		return 0.0f;
+
+	return (float)load->rowsUploaded / (float)load->height;
+}
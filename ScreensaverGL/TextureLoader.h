@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "JobSystem.h"
+
+struct TextureParams
+{
+	GLint wrapS = GL_REPEAT, wrapT = GL_REPEAT;
+	GLint filterMin = GL_NEAREST, filterMag = GL_NEAREST;
+	GLenum format = GL_RGB;
+};
+
+enum TextureLoadResult
+{
+	TextureLoad_Pending,
+	TextureLoad_Ready,
+	TextureLoad_Failed
+};
+
+// Loads textures without stalling the render thread.
+// Files are decoded with stb_image on the job system, then copied a few rows at a time through a staging
+// pixel buffer and uploaded with glTexSubImage2D, for at most budgetMs per frame.
+// The staging buffer is persistently mapped when the driver has buffer storage, orphaned per chunk otherwise.
+struct TextureLoader
+{
+private:
+	enum LoadState
+	{
+		Load_Decoding,
+		Load_Decoded,
+		Load_Uploading,
+		Load_Resident,
+		Load_Failed
+	};
+
+	struct Load
+	{
+		int id = 0;
+		std::string path;
+		TextureParams params;
+
+		// Encoded file when the caller already read it, decoded from memory instead of from path
+		std::vector<unsigned char> fileData;
+
+		std::atomic<int> state{ Load_Decoding };
+
+		unsigned char *pixels = nullptr;
+		int width = 0, height = 0, channels = 0;
+
+		GLuint texture = 0;
+		int rowsUploaded = 0;
+	};
+
+	static constexpr int STAGING_SLOTS = 3;
+	static constexpr GLsizeiptr STAGING_SLOT_SIZE = 4 << 20;
+
+	GLuint pbo = 0;
+	unsigned char *mapped = nullptr;
+
+	GLsync slotFences[STAGING_SLOTS] = {};
+	int nextSlot = 0;
+
+	std::vector<std::unique_ptr<Load>> loads;
+	int nextId = 1;
+
+	JobSystem &jobs;
+	JobFence decodeFence;
+
+	static void decode(void *data, size_t begin, size_t end);
+
+	void createStaging();
+
+	bool uploadChunk(Load &load);
+
+	Load *find(int id);
+
+	int submit(std::unique_ptr<Load> load);
+
+public:
+	// Time the render thread may spend copying pixels each frame
+	double budgetMs = 2.0;
+
+	explicit TextureLoader(JobSystem &jobs);
+	~TextureLoader();
+
+	// Start loading a file, returns an id to poll with take()
+	int request(const char *path, const TextureParams &params);
+
+	// Same as request() for a file that is already in memory, name is only used in error messages
+	int request(std::vector<unsigned char> &&fileData, const char *name, const TextureParams &params);
+
+	// Call once per frame on the render thread
+	void update();
+
+	// Hands the texture over once it is fully uploaded, the loader forgets the id after Ready or Failed.
+	TextureLoadResult take(int id, GLuint &texture, int &width, int &height);
+
+	// 0 while decoding, then the fraction of rows uploaded
+	float getProgress(int id);
+};
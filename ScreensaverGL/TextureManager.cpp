@@ -0,0 +1,290 @@
+#include "TextureManager.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <sys/stat.h>
+
+#include "GLState.h"
+#include "Hash.h"
+
+TextureManager::TextureManager(TextureLoader &loader, JobSystem &jobs)
+	: loader(loader), jobs(jobs)
+{
+}
+
+TextureManager::~TextureManager()
+{
+	hashFence.wait();
+
+	for (Entry &entry : entries)
+	{
+		GLState.forgetTexture(entry.texture);
+		glDeleteTextures(1, &entry.texture);
+	}
+}
+
+void TextureManager::readAndHash(void *data, size_t begin, size_t end)
+{
+	Request *req = (Request *)data;
+
+	std::ifstream file(req->path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		printf("Failed to load texture file\nFile: %s\n", req->path.c_str());
+		req->phase.store(Request_Failed, std::memory_order_release);
+		return;
+	}
+
+	std::streamoff size = file.tellg();
+	file.seekg(0);
+
+	req->fileData.resize(size > 0 ? (size_t)size : 0);
+	file.read((char *)req->fileData.data(), (std::streamsize)req->fileData.size());
+
+	if (size <= 0 || !file)
+	{
+		printf("Failed to read texture file\nFile: %s\n", req->path.c_str());
+		req->phase.store(Request_Failed, std::memory_order_release);
+		return;
+	}
+
+	req->key.contentHash = hashBytes(req->fileData.data(), req->fileData.size());
+	req->phase.store(Request_Hashed, std::memory_order_release);
+}
+
+int TextureManager::acquire(const char *path, const TextureParams &params)
+{
+	std::unique_ptr<Request> req(new Request());
+	req->id = nextId++;
+	req->path = path;
+	req->key.params = params;
+
+	struct stat st;
+	if (stat(path, &st) == 0)
+	{
+		req->fileSize = (long long)st.st_size;
+		req->fileTime = (long long)st.st_mtime;
+	}
+
+	// Same file as before, no need to read it again to know what is inside
+	auto known = knownFiles.find(req->path);
+	if (known != knownFiles.end() && req->fileSize >= 0 &&
+		known->second.size == req->fileSize && known->second.time == req->fileTime)
+	{
+		req->key.contentHash = known->second.contentHash;
+		req->phase = Request_Hashed;
+	}
+	else
+	{
+		Job job;
+		job.func = readAndHash;
+		job.data = req.get();
+		job.begin = 0;
+		job.end = 1;
+		job.fence = &hashFence;
+
+		hashFence.add(1);
+		jobs.submit(job);
+	}
+
+	requests.push_back(std::move(req));
+
+	return requests.back()->id;
+}
+
+TextureManager::Entry *TextureManager::findEntry(const TextureKey &key)
+{
+	for (Entry &entry : entries)
+	{
+		if (entry.key == key)
+			return &entry;
+	}
+
+	return nullptr;
+}
+
+TextureManager::Entry *TextureManager::findEntry(GLuint texture)
+{
+	for (Entry &entry : entries)
+	{
+		if (entry.texture == texture)
+			return &entry;
+	}
+
+	return nullptr;
+}
+
+bool TextureManager::isLoading(const TextureKey &key)
+{
+	for (std::unique_ptr<Request> &req : requests)
+	{
+		if (req->phase.load(std::memory_order_acquire) == Request_Loading && req->key == key)
+			return true;
+	}
+
+	return false;
+}
+
+void TextureManager::update()
+{
+	for (std::unique_ptr<Request> &req : requests)
+	{
+		int phase = req->phase.load(std::memory_order_acquire);
+
+		if (phase == Request_Hashed)
+		{
+			if (req->fileSize >= 0)
+				knownFiles[req->path] = { req->fileSize, req->fileTime, req->key.contentHash };
+
+			if (Entry *entry = findEntry(req->key))
+			{
+				hits++;
+
+				entry->refCount++;
+				entry->lastUse = ++useCounter;
+
+				req->texture = entry->texture;
+				req->width = entry->width;
+				req->height = entry->height;
+				req->phase = Request_Done;
+
+				std::vector<unsigned char>().swap(req->fileData);
+				continue;
+			}
+
+			// Someone else is already uploading the same texture, pick it up from the cache once it lands
+			if (isLoading(req->key))
+				continue;
+
+			misses++;
+
+			if (req->fileData.empty())
+				req->loadId = loader.request(req->path.c_str(), req->key.params);
+			else
+				req->loadId = loader.request(std::move(req->fileData), req->path.c_str(), req->key.params);
+
+			req->phase = Request_Loading;
+		}
+	}
+
+	loader.update();
+
+	for (std::unique_ptr<Request> &req : requests)
+	{
+		if (req->phase.load(std::memory_order_acquire) != Request_Loading)
+			continue;
+
+		GLuint texture;
+		int width, height;
+
+		TextureLoadResult result = loader.take(req->loadId, texture, width, height);
+		if (result == TextureLoad_Pending)
+			continue;
+
+		if (result == TextureLoad_Failed)
+		{
+			req->phase = Request_Failed;
+			continue;
+		}
+
+		Entry entry;
+		entry.key = req->key;
+		entry.texture = texture;
+		entry.width = width;
+		entry.height = height;
+		// Drivers usually pad RGB to RGBA, plus a third for the mip chain
+		entry.bytes = (size_t)width * height * 4 * 4 / 3;
+		entry.refCount = 1;
+		entry.lastUse = ++useCounter;
+
+		entries.push_back(entry);
+		residentBytes += entry.bytes;
+
+		req->texture = texture;
+		req->width = width;
+		req->height = height;
+		req->phase = Request_Done;
+	}
+
+	evict();
+}
+
+TextureLoadResult TextureManager::poll(int id, GLuint &texture, int &width, int &height)
+{
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		Request &req = *requests[i];
+		if (req.id != id)
+			continue;
+
+		int phase = req.phase.load(std::memory_order_acquire);
+		if (phase != Request_Done && phase != Request_Failed)
+			return TextureLoad_Pending;
+
+		texture = req.texture;
+		width = req.width;
+		height = req.height;
+
+		requests.erase(requests.begin() + i);
+
+		return (phase == Request_Done) ? TextureLoad_Ready : TextureLoad_Failed;
+	}
+
+	return TextureLoad_Failed;
+}
+
+float TextureManager::getProgress(int id)
+{
+	for (std::unique_ptr<Request> &req : requests)
+	{
+		if (req->id == id && req->phase.load(std::memory_order_acquire) == Request_Loading)
+			return loader.getProgress(req->loadId);
+	}
+
+	return 0.0f;
+}
+
+void TextureManager::addRef(GLuint texture)
+{
+	if (Entry *entry = findEntry(texture))
+	{
+		entry->refCount++;
+		entry->lastUse = ++useCounter;
+	}
+}
+
+void TextureManager::release(GLuint texture)
+{
+	Entry *entry = findEntry(texture);
+	if (!entry || entry->refCount == 0)
+		return;
+
+	entry->refCount--;
+	entry->lastUse = ++useCounter;
+
+	evict();
+}
+
+void TextureManager::evict()
+{
+	while (residentBytes > vramBudget)
+	{
+		Entry *oldest = nullptr;
+		for (Entry &entry : entries)
+		{
+			if (entry.refCount == 0 && (!oldest || entry.lastUse < oldest->lastUse))
+				oldest = &entry;
+		}
+
+		// Everything left is in use
+		if (!oldest)
+			break;
+
+		GLState.forgetTexture(oldest->texture);
+		glDeleteTextures(1, &oldest->texture);
+
+		residentBytes -= oldest->bytes;
+		entries.erase(entries.begin() + (oldest - entries.data()));
+	}
+}
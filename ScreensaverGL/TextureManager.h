@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "JobSystem.h"
+#include "TextureLoader.h"
+
+// A texture is identified by what is in the file and how it is sampled, not by where the file lives.
+struct TextureKey
+{
+	uint64_t contentHash = 0;
+	TextureParams params;
+
+	bool operator==(const TextureKey &other) const
+	{
+		return contentHash == other.contentHash &&
+			params.wrapS == other.params.wrapS &&
+			params.wrapT == other.params.wrapT &&
+			params.filterMin == other.params.filterMin &&
+			params.filterMag == other.params.filterMag &&
+			params.format == other.params.format;
+	}
+};
+
+// Shares GL textures between everyone asking for the same content, keeps them refcounted
+// and evicts the least recently used unreferenced ones once the VRAM budget is exceeded.
+// Files are hashed on the job system, a path whose size and modification time did not change is not read again.
+struct TextureManager
+{
+private:
+	struct Entry
+	{
+		TextureKey key;
+
+		GLuint texture = 0;
+		int width = 0, height = 0;
+		size_t bytes = 0;
+
+		int refCount = 0;
+		uint64_t lastUse = 0;
+	};
+
+	enum RequestPhase
+	{
+		Request_Hashing,
+		Request_Hashed,
+		Request_Loading,
+		Request_Done,
+		Request_Failed
+	};
+
+	struct Request
+	{
+		int id = 0;
+		std::string path;
+
+		std::atomic<int> phase{ Request_Hashing };
+
+		TextureKey key;
+		std::vector<unsigned char> fileData;
+
+		long long fileSize = -1, fileTime = -1;
+
+		int loadId = 0;
+
+		GLuint texture = 0;
+		int width = 0, height = 0;
+	};
+
+	struct FileInfo
+	{
+		long long size, time;
+		uint64_t contentHash;
+	};
+
+	std::vector<Entry> entries;
+	std::vector<std::unique_ptr<Request>> requests;
+	std::unordered_map<std::string, FileInfo> knownFiles;
+
+	int nextId = 1;
+	uint64_t useCounter = 0;
+	size_t residentBytes = 0;
+
+	TextureLoader &loader;
+	JobSystem &jobs;
+	JobFence hashFence;
+
+	static void readAndHash(void *data, size_t begin, size_t end);
+
+	Entry *findEntry(const TextureKey &key);
+	Entry *findEntry(GLuint texture);
+
+	bool isLoading(const TextureKey &key);
+
+	void evict();
+
+public:
+	// Unreferenced textures are evicted until the estimated resident size fits
+	size_t vramBudget = 256 << 20;
+
+	unsigned hits = 0, misses = 0;
+
+	TextureManager(TextureLoader &loader, JobSystem &jobs);
+	~TextureManager();
+
+	// Start looking up or loading a texture, poll the returned id until it is no longer pending
+	int acquire(const char *path, const TextureParams &params);
+
+	// Call once per frame on the render thread, also drives the loader
+	void update();
+
+	// On Ready the caller holds one reference to texture and has to release() it
+	TextureLoadResult poll(int id, GLuint &texture, int &width, int &height);
+
+	float getProgress(int id);
+
+	void addRef(GLuint texture);
+	void release(GLuint texture);
+
+	size_t getResidentBytes() const { return residentBytes; }
+	int getTextureCount() const { return (int)entries.size(); }
+};
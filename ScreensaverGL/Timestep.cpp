@@ -0,0 +1,55 @@
+#include "Timestep.h"
+
+FixedTimestep::FixedTimestep(uint64_t frequency, double rate)
+	: frequency(frequency)
+{
+	setRate(rate);
+}
+
+void FixedTimestep::setRate(double rate)
+{
+	if (rate <= 0.0)
+		return;
+
+	this->rate = rate;
+
+	stepTicks = (uint64_t)((double)frequency / rate + 0.5);
+	if (stepTicks == 0)
+		stepTicks = 1;
+
+	// Keep the leftover below one step, alpha has to stay in range
+	accumulator %= stepTicks;
+}
+
+int FixedTimestep::advance(uint64_t ticks)
+{
+	if (!started)
+	{
+		started = true;
+		lastTicks = ticks;
+		return 0;
+	}
+
+	uint64_t delta = ticks - lastTicks;
+	lastTicks = ticks;
+
+	return advanceBy(delta);
+}
+
+int FixedTimestep::advanceBy(uint64_t deltaTicks)
+{
+	accumulator += deltaTicks;
+
+	uint64_t steps = accumulator / stepTicks;
+	accumulator -= steps * stepTicks;
+
+	if (steps > (uint64_t)maxSteps)
+	{
+		droppedSteps += steps - maxSteps;
+		steps = maxSteps;
+	}
+
+	totalSteps += steps;
+
+	return (int)steps;
+}
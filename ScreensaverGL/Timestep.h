@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// Fixed rate simulation clock. Time is counted in integer timer ticks, so it keeps full precision
+// however long the app has been running. Rendering blends the last two steps by getAlpha().
+struct FixedTimestep
+{
+private:
+	uint64_t frequency;
+	uint64_t stepTicks = 1;
+	uint64_t accumulator = 0;
+	uint64_t lastTicks = 0;
+	bool started = false;
+
+	double rate = 0.0;
+
+public:
+	// Most steps run in one frame, time beyond that is dropped so a long hitch cannot spiral
+	int maxSteps = 8;
+
+	uint64_t totalSteps = 0;
+	uint64_t droppedSteps = 0;
+
+	// frequency is in ticks per second, rate in steps per second
+	FixedTimestep(uint64_t frequency, double rate = 120.0);
+
+	void setRate(double rate);
+
+	double getRate() const { return rate; }
+
+	// Seconds per step, exactly what the rounded tick count amounts to
+	float getStepTime() const { return (float)((double)stepTicks / (double)frequency); }
+
+	// Feed the current timer value, returns how many steps to run this frame.
+	// The first call only starts the clock.
+	int advance(uint64_t ticks);
+
+	// Same as advance(), for a known amount of elapsed ticks
+	int advanceBy(uint64_t deltaTicks);
+
+	// How far the frame is between the previous and the latest step, in [0, 1)
+	float getAlpha() const { return (float)((double)accumulator / (double)stepTicks); }
+
+	uint64_t getFrequency() const { return frequency; }
+};
@@ -0,0 +1,481 @@
+#include "VideoCapture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define VIDEO_SSE2
+#include <emmintrin.h>
+#endif
+
+// Full range BT.601 in 8.8 fixed point:
+//   Y =  0.299 R + 0.587 G + 0.114 B
+//   U = -0.169 R - 0.331 G + 0.500 B + 128
+//   V =  0.500 R - 0.419 G - 0.081 B + 128
+// The chroma bias of 128.5 << 8 keeps every sum positive, so shifting right rounds the same way everywhere.
+#define LUMA_BIAS	128
+#define CHROMA_BIAS	32896
+
+// Saturated primaries land one past 255 before the shift
+static inline unsigned char clampByte(int value)
+{
+	return (unsigned char)std::min(std::max(value, 0), 255);
+}
+
+static inline unsigned char getLuma(const unsigned char *p)
+{
+	return (unsigned char)((77 * p[0] + 150 * p[1] + 29 * p[2] + LUMA_BIAS) >> 8);
+}
+
+// One pair of output rows from src0 and src1, which are the same row for the last line of an odd height
+static void convertRowsScalar(const unsigned char *src0, const unsigned char *src1, int begin, int width,
+	unsigned char *y0, unsigned char *y1, unsigned char *u, unsigned char *v)
+{
+	for (int x = begin; x < width; x += 2)
+	{
+		int x1 = std::min(x + 1, width - 1);
+
+		const unsigned char *a = src0 + x * 4, *b = src0 + x1 * 4;
+		const unsigned char *c = src1 + x * 4, *d = src1 + x1 * 4;
+
+		y0[x] = getLuma(a);
+		y0[x1] = getLuma(b);
+		y1[x] = getLuma(c);
+		y1[x1] = getLuma(d);
+
+		int r = (a[0] + b[0] + c[0] + d[0] + 2) >> 2;
+		int g = (a[1] + b[1] + c[1] + d[1] + 2) >> 2;
+		int bl = (a[2] + b[2] + c[2] + d[2] + 2) >> 2;
+
+		u[x / 2] = clampByte((-43 * r - 85 * g + 128 * bl + CHROMA_BIAS) >> 8);
+		v[x / 2] = clampByte((128 * r - 107 * g - 21 * bl + CHROMA_BIAS) >> 8);
+	}
+}
+
+#ifdef VIDEO_SSE2
+// Weighted sum of the RGB channels of 4 RGBA pixels, as 4 ints
+static inline __m128i dotRGB(__m128i pixels, __m128i weights, __m128i bias)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	// (r * wr + g * wg, b * wb + a * 0) per pixel
+	__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+	__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+
+	__m128 rg = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0));
+	__m128 ba = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1));
+
+	__m128i sum = _mm_add_epi32(_mm_castps_si128(rg), _mm_castps_si128(ba));
+	return _mm_srai_epi32(_mm_add_epi32(sum, bias), 8);
+}
+
+// 8 pixels of both rows per iteration, returns where the scalar loop has to take over.
+// Chroma averages with two rounding _mm_avg_epu8, which can be one off from the scalar sum.
+static int convertRowsSSE2(const unsigned char *src0, const unsigned char *src1, int width,
+	unsigned char *y0, unsigned char *y1, unsigned char *u, unsigned char *v)
+{
+	const __m128i lumaWeights = _mm_setr_epi16(77, 150, 29, 0, 77, 150, 29, 0);
+	const __m128i uWeights = _mm_setr_epi16(-43, -85, 128, 0, -43, -85, 128, 0);
+	const __m128i vWeights = _mm_setr_epi16(128, -107, -21, 0, 128, -107, -21, 0);
+	const __m128i lumaBias = _mm_set1_epi32(LUMA_BIAS);
+	const __m128i chromaBias = _mm_set1_epi32(CHROMA_BIAS);
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8)
+	{
+		__m128i a0 = _mm_loadu_si128((const __m128i *)(src0 + x * 4));
+		__m128i a1 = _mm_loadu_si128((const __m128i *)(src0 + x * 4 + 16));
+		__m128i b0 = _mm_loadu_si128((const __m128i *)(src1 + x * 4));
+		__m128i b1 = _mm_loadu_si128((const __m128i *)(src1 + x * 4 + 16));
+
+		__m128i lumaA = _mm_packs_epi32(dotRGB(a0, lumaWeights, lumaBias), dotRGB(a1, lumaWeights, lumaBias));
+		__m128i lumaB = _mm_packs_epi32(dotRGB(b0, lumaWeights, lumaBias), dotRGB(b1, lumaWeights, lumaBias));
+		_mm_storel_epi64((__m128i *)(y0 + x), _mm_packus_epi16(lumaA, zero));
+		_mm_storel_epi64((__m128i *)(y1 + x), _mm_packus_epi16(lumaB, zero));
+
+		// Average the rows, then neighbouring pixels, leaving the 4 pixels of this block's chroma
+		__m128i m0 = _mm_avg_epu8(a0, b0);
+		__m128i m1 = _mm_avg_epu8(a1, b1);
+		__m128 even = _mm_shuffle_ps(_mm_castsi128_ps(m0), _mm_castsi128_ps(m1), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(m0), _mm_castsi128_ps(m1), _MM_SHUFFLE(3, 1, 3, 1));
+		__m128i block = _mm_avg_epu8(_mm_castps_si128(even), _mm_castps_si128(odd));
+
+		__m128i chromaU = _mm_packs_epi32(dotRGB(block, uWeights, chromaBias), zero);
+		__m128i chromaV = _mm_packs_epi32(dotRGB(block, vWeights, chromaBias), zero);
+
+		int packedU = _mm_cvtsi128_si32(_mm_packus_epi16(chromaU, zero));
+		int packedV = _mm_cvtsi128_si32(_mm_packus_epi16(chromaV, zero));
+		memcpy(u + x / 2, &packedU, 4);
+		memcpy(v + x / 2, &packedV, 4);
+	}
+
+	return x;
+}
+#endif
+
+void convertRGBAToYUV420(const unsigned char *rgba, int width, int height, int stride, unsigned char *y, unsigned char *u, unsigned char *v)
+{
+	int chromaWidth = (width + 1) / 2;
+	int chromaHeight = (height + 1) / 2;
+
+	for (int cy = 0; cy < chromaHeight; cy++)
+	{
+		int row0 = cy * 2;
+		int row1 = std::min(row0 + 1, height - 1);
+
+		// GL rows start at the bottom
+		const unsigned char *src0 = rgba + (size_t)(height - 1 - row0) * stride;
+		const unsigned char *src1 = rgba + (size_t)(height - 1 - row1) * stride;
+
+		unsigned char *y0 = y + (size_t)row0 * width;
+		unsigned char *y1 = y + (size_t)row1 * width;
+		unsigned char *uRow = u + (size_t)cy * chromaWidth;
+		unsigned char *vRow = v + (size_t)cy * chromaWidth;
+
+		int x = 0;
+#ifdef VIDEO_SSE2
+		x = convertRowsSSE2(src0, src1, width, y0, y1, uRow, vRow);
+#endif
+		convertRowsScalar(src0, src1, x, width, y0, y1, uRow, vRow);
+	}
+}
+
+// Each 2x2 block is one color, so the chroma average is exact in every converter
+#define CHECK_COLORS	8
+#define CHECK_WIDTH		(CHECK_COLORS * 2)
+
+static const unsigned char CHECK_RGB[CHECK_COLORS][3] = {
+	{ 0, 0, 0 }, { 255, 0, 0 }, { 0, 255, 0 }, { 0, 0, 255 },
+	{ 255, 255, 0 }, { 0, 255, 255 }, { 255, 0, 255 }, { 255, 255, 255 }
+};
+
+static unsigned char getReferenceByte(double value)
+{
+	return (unsigned char)std::lround(std::min(std::max(value, 0.0), 255.0));
+}
+
+// Compares against the floating point formulas, the fixed point weights are allowed to be one off
+static bool checkAgainstReference(const char *name, const unsigned char *y, const unsigned char *u, const unsigned char *v)
+{
+	bool ok = true;
+
+	for (int i = 0; i < CHECK_COLORS; i++)
+	{
+		double r = CHECK_RGB[i][0], g = CHECK_RGB[i][1], b = CHECK_RGB[i][2];
+
+		int expected[3] = {
+			getReferenceByte(0.299 * r + 0.587 * g + 0.114 * b),
+			getReferenceByte(-0.168736 * r - 0.331264 * g + 0.5 * b + 128.0),
+			getReferenceByte(0.5 * r - 0.418688 * g - 0.081312 * b + 128.0)
+		};
+		int actual[3] = { y[i * 2], u[i], v[i] };
+
+		for (int c = 0; c < 3; c++)
+		{
+			if (std::abs(actual[c] - expected[c]) > 1)
+			{
+				printf("%s converter: %c of RGB (%d, %d, %d) is %d, expected %d\n", name, "YUV"[c],
+					CHECK_RGB[i][0], CHECK_RGB[i][1], CHECK_RGB[i][2], actual[c], expected[c]);
+				ok = false;
+			}
+		}
+	}
+
+	return ok;
+}
+
+bool checkVideoConverters()
+{
+	unsigned char rgba[CHECK_WIDTH * 4];
+	for (int x = 0; x < CHECK_WIDTH; x++)
+	{
+		memcpy(rgba + x * 4, CHECK_RGB[x / 2], 3);
+		rgba[x * 4 + 3] = 255;
+	}
+
+	// Both rows of every block come from the same source row
+	unsigned char y[2][CHECK_WIDTH], u[CHECK_COLORS], v[CHECK_COLORS];
+	convertRowsScalar(rgba, rgba, 0, CHECK_WIDTH, y[0], y[1], u, v);
+
+	bool ok = checkAgainstReference("Scalar", y[0], u, v);
+
+#ifdef VIDEO_SSE2
+	unsigned char simdY[2][CHECK_WIDTH], simdU[CHECK_COLORS], simdV[CHECK_COLORS];
+	int converted = convertRowsSSE2(rgba, rgba, CHECK_WIDTH, simdY[0], simdY[1], simdU, simdV);
+
+	if (converted != CHECK_WIDTH)
+	{
+		printf("SSE2 converter stopped at column %d of %d\n", converted, CHECK_WIDTH);
+		return false;
+	}
+
+	ok = checkAgainstReference("SSE2", simdY[0], simdU, simdV) && ok;
+
+	if (memcmp(y, simdY, sizeof(y)) != 0 || memcmp(u, simdU, sizeof(u)) != 0 || memcmp(v, simdV, sizeof(v)) != 0)
+	{
+		printf("Scalar and SSE2 converters disagree on saturated colors\n");
+		ok = false;
+	}
+#endif
+
+	return ok;
+}
+
+VideoFormat getVideoFormatForPath(const char *path)
+{
+	size_t length = strlen(path);
+
+	if (strcmp(path, "-") == 0 || (length >= 4 && strcmp(path + length - 4, ".y4m") == 0))
+		return VideoFormat_Y4M;
+
+	return VideoFormat_RGBA;
+}
+
+const char *getVideoFormatName(VideoFormat format)
+{
+	switch (format)
+	{
+	case VideoFormat_Y4M:	return "Y4M";
+	case VideoFormat_RGBA:	return "Raw RGBA";
+	default:				return "Unknown";
+	}
+}
+
+VideoCapture::VideoCapture(JobSystem &jobs)
+	: jobs(jobs)
+{
+}
+
+VideoCapture::~VideoCapture()
+{
+	close();
+}
+
+bool VideoCapture::open(const char *path, VideoFormat format, int width, int height, int fps)
+{
+	close();
+
+	// Only a few pixels, and a broken converter would spoil the whole video
+	if (format == VideoFormat_Y4M && !checkVideoConverters())
+	{
+		printf("RGBA to YUV conversion is broken, not capturing\n");
+		return false;
+	}
+
+	if (strcmp(path, "-") == 0)
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		out = &std::cout;
+	}
+	else
+	{
+		file.open(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			printf("Cannot open %s for writing\n", path);
+			return false;
+		}
+
+		out = &file;
+	}
+
+	this->format = format;
+	this->width = width;
+	this->height = height;
+	this->fps = fps;
+
+	failed = false;
+	framesWritten = 0;
+	stalls = 0;
+
+	if (format == VideoFormat_Y4M)
+	{
+		char header[128];
+		snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+		out->write(header, strlen(header));
+
+		size_t chromaSize = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+		planes.resize((size_t)width * height + 2 * chromaSize);
+	}
+
+	GLsizeiptr bytes = (GLsizeiptr)width * height * 4;
+
+	for (Slot &slot : slots)
+	{
+		glGenBuffers(1, &slot.pbo);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	oldest = 0;
+	pending = 0;
+
+	return true;
+}
+
+void VideoCapture::close()
+{
+	if (!out)
+		return;
+
+	while (pending > 0)
+		writeOldest(true);
+
+	releaseMapped();
+
+	for (Slot &slot : slots)
+	{
+		glDeleteBuffers(1, &slot.pbo);
+		slot.pbo = 0;
+	}
+
+	out->flush();
+
+	if (file.is_open())
+		file.close();
+
+	out = nullptr;
+}
+
+void VideoCapture::encode(void *data, size_t begin, size_t end)
+{
+	VideoCapture *capture = (VideoCapture *)data;
+	capture->writeFrame(capture->mappedPixels);
+}
+
+void VideoCapture::writeFrame(const unsigned char *pixels)
+{
+	int stride = width * 4;
+
+	if (format == VideoFormat_Y4M)
+	{
+		size_t lumaSize = (size_t)width * height;
+		size_t chromaSize = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+
+		unsigned char *y = planes.data();
+		unsigned char *u = y + lumaSize;
+		unsigned char *v = u + chromaSize;
+
+		convertRGBAToYUV420(pixels, width, height, stride, y, u, v);
+
+		out->write("FRAME\n", 6);
+		out->write((const char *)planes.data(), planes.size());
+	}
+	else
+	{
+		for (int row = height - 1; row >= 0; row--)
+			out->write((const char *)pixels + (size_t)row * stride, stride);
+	}
+
+	if (!*out)
+		failed = true;
+}
+
+void VideoCapture::releaseMapped()
+{
+	if (mappedSlot < 0)
+		return;
+
+	// The encoder reads straight from the mapping
+	encodeFence.wait();
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[mappedSlot].pbo);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	mappedSlot = -1;
+	mappedPixels = nullptr;
+}
+
+bool VideoCapture::writeOldest(bool wait)
+{
+	Slot &slot = slots[oldest];
+
+	GLenum result = glClientWaitSync(slot.fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		if (!wait)
+			return false;
+
+		do
+			result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	glDeleteSync(slot.fence);
+	slot.fence = 0;
+
+	// One frame in the encoder at a time keeps the output in order
+	releaseMapped();
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+	mappedPixels = (const unsigned char *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)width * height * 4, GL_MAP_READ_BIT);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	int index = oldest;
+	oldest = (oldest + 1) % CAPTURE_SLOTS;
+	pending--;
+
+	if (!mappedPixels)
+	{
+		failed = true;
+		return true;
+	}
+
+	mappedSlot = index;
+
+	Job job;
+	job.func = encode;
+	job.data = this;
+	job.begin = 0;
+	job.end = 1;
+	job.fence = &encodeFence;
+
+	encodeFence.add(1);
+	jobs.submit(job);
+
+	framesWritten++;
+
+	return true;
+}
+
+void VideoCapture::capture()
+{
+	if (!out)
+		return;
+
+	// Hand every readback the GPU is done with to the encoder, without waiting
+	while (pending > 0 && writeOldest(false))
+	{
+	}
+
+	if (pending == CAPTURE_SLOTS)
+	{
+		stalls++;
+		writeOldest(true);
+	}
+
+	int index = (oldest + pending) % CAPTURE_SLOTS;
+	if (index == mappedSlot)
+		releaseMapped();
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[index].pbo);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid *)0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slots[index].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	pending++;
+}
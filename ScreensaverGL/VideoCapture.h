@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "JobSystem.h"
+
+enum VideoFormat
+{
+	VideoFormat_Y4M,
+	VideoFormat_RGBA
+};
+
+// Picks Y4M for "-" and .y4m paths, raw RGBA otherwise
+VideoFormat getVideoFormatForPath(const char *path);
+
+const char *getVideoFormatName(VideoFormat format);
+
+// Streams rendered frames to a file, or to stdout for "-", one frame per capture() call.
+// Frames are read back into a ring of pixel pack buffers and only mapped a couple of frames later, once their fence
+// has passed, so glReadPixels never waits for the GPU. Flipping and the RGB to YUV 4:2:0 conversion for Y4M run on a
+// worker, straight from the mapped buffer, one frame at a time so the frames are written in order.
+// Y4M is full range BT.601 (C420jpeg), raw RGBA is top row first with no header.
+struct VideoCapture
+{
+private:
+	static constexpr int CAPTURE_SLOTS = 3;
+
+	struct Slot
+	{
+		GLuint pbo = 0;
+		GLsync fence = 0;
+	};
+
+	Slot slots[CAPTURE_SLOTS];
+
+	// Slots holding a readback that is not written yet, oldest first
+	int oldest = 0;
+	int pending = 0;
+
+	// Slot mapped for the encoder, -1 when none
+	int mappedSlot = -1;
+	const unsigned char *mappedPixels = nullptr;
+
+	JobSystem &jobs;
+	JobFence encodeFence;
+
+	std::ofstream file;
+	std::ostream *out = nullptr;
+
+	VideoFormat format = VideoFormat_Y4M;
+	int width = 0, height = 0;
+	int fps = 60;
+
+	// Encoder output, reused every frame
+	std::vector<unsigned char> planes;
+
+	// Set by the encoder
+	std::atomic<bool> failed{ false };
+
+	static void encode(void *data, size_t begin, size_t end);
+
+	void writeFrame(const unsigned char *pixels);
+
+	void releaseMapped();
+
+	// Map the oldest readback and hand it to the encoder, waiting for the GPU if it has to
+	bool writeOldest(bool wait);
+
+public:
+	// Frames handed to the encoder, and how often the ring was full and capture() had to wait for the GPU
+	unsigned framesWritten = 0;
+	unsigned stalls = 0;
+
+	explicit VideoCapture(JobSystem &jobs);
+	~VideoCapture();
+
+	// The size is fixed for the whole capture. Returns false when the output cannot be opened.
+	bool open(const char *path, VideoFormat format, int width, int height, int fps);
+
+	// Write every frame still in flight, then close the output.
+	void close();
+
+	// Queue a readback of the framebuffer bound for reading, call after the frame is drawn and before the swap.
+	void capture();
+
+	bool isOpen() const { return out != nullptr; }
+
+	// A write failed, e.g. the pipe was closed, the capture should be stopped
+	bool hasFailed() const { return failed; }
+
+	int getFps() const { return fps; }
+};
+
+// RGBA rows to full range BT.601 Y, U and V planes with 2x2 subsampled chroma, flipping vertically on the way.
+// stride is the distance between source rows in bytes. Odd sizes round the chroma planes up.
+void convertRGBAToYUV420(const unsigned char *rgba, int width, int height, int stride, unsigned char *y, unsigned char *u, unsigned char *v);
+
+// Converts the corners of the RGB cube with the scalar and the SIMD converter and compares them with each other
+// and with the floating point formulas, printing every mismatch. Returns false when any is found.
+bool checkVideoConverters();
@@ -86,6 +86,22 @@
 // The only purpose of this define is if you want force compilation of the stb_truetype backend ALONG with the FreeType backend.
 //#define IMGUI_ENABLE_STB_TRUETYPE
 
+//---- Hash used for IDs by ImHashData()/ImHashStr(), the default is a CRC32 walking a 1KB table one byte at a time.
+// IDs change with the hash, so IDs saved by a build using another one (e.g. [Table] entries in .ini files) are not found again.
+// Compare them with 'ScreensaverGLBench --hash on'.
+//#define IMGUI_HASH_CRC32C     // Hardware CRC32C. Requires SSE4.2 (-msse4.2, /arch:AVX or above) or ARMv8 CRC (-march=armv8-a+crc) at compile time.
+#define IMGUI_HASH_WYHASH       // wyhash over 64-bit lanes, portable.
+
+//---- Keep ImGuiStorage pairs (tree node state, window and table lookups) in an open addressing hash index instead of a sorted vector.
+// Inserting a new key is O(1) instead of moving every pair after it, which adds up with thousands of tree nodes or IDs.
+// Pairs in ImGuiStorage::Data are in insertion order then, call BuildSortByKey() after writing to Data directly.
+#define IMGUI_STORAGE_HASHMAP
+
+//---- Cache the size and glyph quads of short text per context, keyed by font, size, text and wrap width, evicted after IM_TEXT_LAYOUT_CACHE_MAX_AGE frames unused.
+// Labels drawn every frame are then measured once and copied into the draw list instead of being laid out again.
+// Text drawn from the cache is only culled as a whole against the clip rectangle, the GPU scissor clips the rest.
+#define IMGUI_TEXT_LAYOUT_CACHE
+
 //---- Define constructor and implicit cast operators to convert back<>forth between your math types and ImVec2/ImVec4.
 // This will be inlined as part of ImVec2 and ImVec4 class declarations.
 /*
@@ -1968,10 +1968,28 @@ static const ImU32 GCrc32LookupTable[256] =
     0xBDBDF21C,0xCABAC28A,0x53B39330,0x24B4A3A6,0xBAD03605,0xCDD70693,0x54DE5729,0x23D967BF,0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D,
 };
 
-// Known size hash
-// It is ok to call ImHashData on a string with known length but the ### operator won't be supported.
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
-ImGuiID ImHashData(const void* data_p, size_t data_size, ImGuiID seed)
+// Hardware CRC32C needs the instructions enabled at compile time, there is no runtime dispatch.
+// (MSVC has no SSE4.2 switch: /arch:AVX and above imply it)
+#if defined(IMGUI_ENABLE_SSE) && (defined(__SSE4_2__) || (defined(_MSC_VER) && defined(__AVX__)))
+#include <nmmintrin.h>
+#define IMGUI_HAS_CRC32C_SSE42
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define IMGUI_HAS_CRC32C_ARM
+#endif
+
+#if defined(IMGUI_HASH_CRC32C) && defined(IMGUI_HASH_WYHASH)
+#error "Define only one of IMGUI_HASH_CRC32C and IMGUI_HASH_WYHASH"
+#endif
+#if defined(IMGUI_HASH_CRC32C) && !defined(IMGUI_HAS_CRC32C_SSE42) && !defined(IMGUI_HAS_CRC32C_ARM)
+#error "IMGUI_HASH_CRC32C needs SSE4.2 (-msse4.2, /arch:AVX) or ARMv8 CRC (-march=armv8-a+crc) instructions"
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>     // _umul128
+#endif
+
+static ImGuiID ImHashDataCrc32(const void* data_p, size_t data_size, ImGuiID seed)
 {
     ImU32 crc = ~seed;
     const unsigned char* data = (const unsigned char*)data_p;
@@ -1981,13 +1999,197 @@ ImGuiID ImHashData(const void* data_p, size_t data_size, ImGuiID seed)
     return ~crc;
 }
 
+// Same result as consuming the data byte by byte, wider loads only change the speed.
+static ImGuiID ImHashDataCrc32c(const void* data_p, size_t data_size, ImGuiID seed)
+{
+    const unsigned char* data = (const unsigned char*)data_p;
+#if defined(IMGUI_HAS_CRC32C_SSE42) && (defined(_M_X64) || defined(__x86_64__))
+    ImU64 crc = ~seed;
+    for (; data_size >= 8; data += 8, data_size -= 8)
+    {
+        ImU64 v;
+        memcpy(&v, data, 8);
+        crc = _mm_crc32_u64(crc, v);
+    }
+    ImU32 crc32 = (ImU32)crc;
+    while (data_size-- != 0)
+        crc32 = _mm_crc32_u8(crc32, *data++);
+    return ~crc32;
+#elif defined(IMGUI_HAS_CRC32C_SSE42)
+    ImU32 crc = ~seed;
+    for (; data_size >= 4; data += 4, data_size -= 4)
+    {
+        ImU32 v;
+        memcpy(&v, data, 4);
+        crc = _mm_crc32_u32(crc, v);
+    }
+    while (data_size-- != 0)
+        crc = _mm_crc32_u8(crc, *data++);
+    return ~crc;
+#elif defined(IMGUI_HAS_CRC32C_ARM)
+    ImU32 crc = ~seed;
+    for (; data_size >= 8; data += 8, data_size -= 8)
+    {
+        ImU64 v;
+        memcpy(&v, data, 8);
+        crc = __crc32cd(crc, v);
+    }
+    while (data_size-- != 0)
+        crc = __crc32cb(crc, *data++);
+    return ~crc;
+#else
+    IM_UNUSED(data);
+    IM_UNUSED(data_size);
+    IM_UNUSED(seed);
+    IM_ASSERT(0 && "CRC32C is not available in this build, see ImHashBackendIsAvailable()");
+    return 0;
+#endif
+}
+
+// wyhash final version 4 by Wang Yi (public domain/unlicense), reading little-endian 64-bit lanes.
+static inline void ImWyMul(ImU64* a, ImU64* b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (ImU64)r;
+    *b = (ImU64)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    ImU64 ha = *a >> 32, hb = *b >> 32, la = (ImU32)*a, lb = (ImU32)*b;
+    ImU64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+    ImU64 c = t < rl;
+    ImU64 lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+static inline ImU64 ImWyMix(ImU64 a, ImU64 b)   { ImWyMul(&a, &b); return a ^ b; }
+static inline ImU64 ImWyRead8(const unsigned char* p) { ImU64 v; memcpy(&v, p, 8); return v; }
+static inline ImU64 ImWyRead4(const unsigned char* p) { ImU32 v; memcpy(&v, p, 4); return v; }
+static inline ImU64 ImWyRead3(const unsigned char* p, size_t k) { return (((ImU64)p[0]) << 16) | (((ImU64)p[k >> 1]) << 8) | p[k - 1]; }
+
+static ImGuiID ImHashDataWyhash(const void* data_p, size_t data_size, ImGuiID seed_32)
+{
+    static const ImU64 secret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+    const unsigned char* p = (const unsigned char*)data_p;
+    ImU64 seed = seed_32;
+    seed ^= ImWyMix(seed ^ secret[0], secret[1]);
+    ImU64 a, b;
+    if (data_size <= 16)
+    {
+        if (data_size >= 4)
+        {
+            a = (ImWyRead4(p) << 32) | ImWyRead4(p + ((data_size >> 3) << 2));
+            b = (ImWyRead4(p + data_size - 4) << 32) | ImWyRead4(p + data_size - 4 - ((data_size >> 3) << 2));
+        }
+        else if (data_size > 0)
+        {
+            a = ImWyRead3(p, data_size);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = data_size;
+        if (i >= 48)
+        {
+            ImU64 see1 = seed, see2 = seed;
+            do
+            {
+                seed = ImWyMix(ImWyRead8(p) ^ secret[1], ImWyRead8(p + 8) ^ seed);
+                see1 = ImWyMix(ImWyRead8(p + 16) ^ secret[2], ImWyRead8(p + 24) ^ see1);
+                see2 = ImWyMix(ImWyRead8(p + 32) ^ secret[3], ImWyRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16)
+        {
+            seed = ImWyMix(ImWyRead8(p) ^ secret[1], ImWyRead8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = ImWyRead8(p + i - 16);
+        b = ImWyRead8(p + i - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    ImWyMul(&a, &b);
+    ImU64 h = ImWyMix(a ^ secret[0] ^ data_size, b ^ secret[1]);
+    return (ImGuiID)(h ^ (h >> 32));
+}
+
+ImHashBackend ImHashBackendGetCurrent()
+{
+#if defined(IMGUI_HASH_CRC32C)
+    return ImHashBackend_Crc32c;
+#elif defined(IMGUI_HASH_WYHASH)
+    return ImHashBackend_Wyhash;
+#else
+    return ImHashBackend_Crc32;
+#endif
+}
+
+bool ImHashBackendIsAvailable(ImHashBackend backend)
+{
+    switch (backend)
+    {
+    case ImHashBackend_Crc32:   return true;
+#if defined(IMGUI_HAS_CRC32C_SSE42) || defined(IMGUI_HAS_CRC32C_ARM)
+    case ImHashBackend_Crc32c:  return true;
+#endif
+    case ImHashBackend_Wyhash:  return true;
+    default:                    return false;
+    }
+}
+
+const char* ImHashBackendGetName(ImHashBackend backend)
+{
+    switch (backend)
+    {
+    case ImHashBackend_Crc32:   return "CRC32";
+    case ImHashBackend_Crc32c:  return "CRC32C";
+    case ImHashBackend_Wyhash:  return "wyhash";
+    default:                    return "Unknown";
+    }
+}
+
+// Known size hash
+// It is ok to call ImHashData on a string with known length but the ### operator won't be supported.
+ImGuiID ImHashData(const void* data_p, size_t data_size, ImGuiID seed)
+{
+#if defined(IMGUI_HASH_CRC32C)
+    return ImHashDataCrc32c(data_p, data_size, seed);
+#elif defined(IMGUI_HASH_WYHASH)
+    return ImHashDataWyhash(data_p, data_size, seed);
+#else
+    return ImHashDataCrc32(data_p, data_size, seed);
+#endif
+}
+
+ImGuiID ImHashDataEx(ImHashBackend backend, const void* data_p, size_t data_size, ImGuiID seed)
+{
+    switch (backend)
+    {
+    case ImHashBackend_Crc32c:  return ImHashDataCrc32c(data_p, data_size, seed);
+    case ImHashBackend_Wyhash:  return ImHashDataWyhash(data_p, data_size, seed);
+    default:                    return ImHashDataCrc32(data_p, data_size, seed);
+    }
+}
+
 // Zero-terminated string hash, with support for ### to reset back to seed value
 // We support a syntax of "label###id" where only "###id" is included in the hash, and only "label" gets displayed.
 // Because this syntax is rarely used we are optimizing for the common case.
 // - If we reach ### in the string we discard the hash so far and reset to the seed.
 // - We don't do 'current += 2; continue;' after handling ### to keep the code smaller/faster (measured ~10% diff in Debug build)
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
-ImGuiID ImHashStr(const char* data_p, size_t data_size, ImGuiID seed)
+static ImGuiID ImHashStrCrc32(const char* data_p, size_t data_size, ImGuiID seed)
 {
     seed = ~seed;
     ImU32 crc = seed;
@@ -2015,6 +2217,37 @@ ImGuiID ImHashStr(const char* data_p, size_t data_size, ImGuiID seed)
     return ~crc;
 }
 
+// Backends hashing several bytes at a time cannot reset half way through, they hash what follows the last ### instead,
+// which gives the same result. Same as ImHashData() on strings without ###.
+static const char* ImHashStrFindIdStart(const char* str, const char* str_end)
+{
+    const char* start = str;
+    for (const char* p = str; (p = (const char*)memchr(p, '#', (size_t)(str_end - p))) != NULL; p++)
+        if (str_end - p >= 3 && p[1] == '#' && p[2] == '#')
+            start = p;
+    return start;
+}
+
+ImGuiID ImHashStrEx(ImHashBackend backend, const char* data_p, size_t data_size, ImGuiID seed)
+{
+    if (backend != ImHashBackend_Crc32c && backend != ImHashBackend_Wyhash)
+        return ImHashStrCrc32(data_p, data_size, seed);
+    const char* data_end = data_p + (data_size != 0 ? data_size : strlen(data_p));
+    const char* id_start = ImHashStrFindIdStart(data_p, data_end);
+    return ImHashDataEx(backend, id_start, (size_t)(data_end - id_start), seed);
+}
+
+ImGuiID ImHashStr(const char* data_p, size_t data_size, ImGuiID seed)
+{
+#if defined(IMGUI_HASH_CRC32C) || defined(IMGUI_HASH_WYHASH)
+    const char* data_end = data_p + (data_size != 0 ? data_size : strlen(data_p));
+    const char* id_start = ImHashStrFindIdStart(data_p, data_end);
+    return ImHashData(id_start, (size_t)(data_end - id_start), seed);
+#else
+    return ImHashStrCrc32(data_p, data_size, seed);
+#endif
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] MISC HELPERS/UTILITIES (File functions)
 //-----------------------------------------------------------------------------
@@ -2357,6 +2590,58 @@ void ImGui::ColorConvertHSVtoRGB(float h, float s, float v, float& out_r, float&
 // Helper: Key->value storage
 //-----------------------------------------------------------------------------
 
+#ifdef IMGUI_STORAGE_HASHMAP
+
+// Keys are usually hashes already, mixing only guards against sequential keys from PushID(int) and the like
+static inline ImU32 ImGuiStorageHashKey(ImGuiID key)
+{
+    ImU32 h = key * 0x9E3779B1u;
+    return h ^ (h >> 16);
+}
+
+// Linear probing, returns the slot holding key or the empty slot ending its probe sequence. There are no deletions so no tombstones.
+static int ImGuiStorageFindSlot(const ImVector<int>& index, const ImVector<ImGuiStorage::ImGuiStoragePair>& data, ImGuiID key)
+{
+    const int mask = index.Size - 1;
+    for (int slot = (int)(ImGuiStorageHashKey(key) & (ImU32)mask); ; slot = (slot + 1) & mask)
+    {
+        const int n = index.Data[slot];
+        if (n < 0 || data.Data[n].key == key)
+            return slot;
+    }
+}
+
+static void ImGuiStorageRebuildIndex(ImGuiStorage* storage, int index_size)
+{
+    storage->Index.resize(index_size);
+    memset(storage->Index.Data, 0xFF, (size_t)index_size * sizeof(int));
+    for (int n = 0; n < storage->Data.Size; n++)
+        storage->Index[ImGuiStorageFindSlot(storage->Index, storage->Data, storage->Data[n].key)] = n;
+}
+
+static ImGuiStorage::ImGuiStoragePair* ImGuiStorageFindPair(const ImGuiStorage* storage, ImGuiID key)
+{
+    if (storage->Index.Size == 0)
+        return NULL;
+    const int n = storage->Index[ImGuiStorageFindSlot(storage->Index, storage->Data, key)];
+    return (n >= 0) ? &const_cast<ImGuiStorage*>(storage)->Data.Data[n] : NULL;
+}
+
+// Returns the pair for new_pair.key, inserting new_pair when missing
+static ImGuiStorage::ImGuiStoragePair* ImGuiStorageFindOrInsertPair(ImGuiStorage* storage, const ImGuiStorage::ImGuiStoragePair& new_pair)
+{
+    if ((storage->Data.Size + 1) * 2 > storage->Index.Size)
+        ImGuiStorageRebuildIndex(storage, storage->Index.Size ? storage->Index.Size * 2 : 16);
+    const int slot = ImGuiStorageFindSlot(storage->Index, storage->Data, new_pair.key);
+    if (storage->Index[slot] >= 0)
+        return &storage->Data[storage->Index[slot]];
+    storage->Index[slot] = storage->Data.Size;
+    storage->Data.push_back(new_pair);
+    return &storage->Data.back();
+}
+
+#else
+
 // std::lower_bound but without the bullshit
 static ImGuiStorage::ImGuiStoragePair* LowerBound(ImVector<ImGuiStorage::ImGuiStoragePair>& data, ImGuiID key)
 {
@@ -2380,6 +2665,27 @@ static ImGuiStorage::ImGuiStoragePair* LowerBound(ImVector<ImGuiStorage::ImGuiSt
     return first;
 }
 
+static ImGuiStorage::ImGuiStoragePair* ImGuiStorageFindPair(const ImGuiStorage* storage, ImGuiID key)
+{
+    ImVector<ImGuiStorage::ImGuiStoragePair>& data = const_cast<ImVector<ImGuiStorage::ImGuiStoragePair>&>(storage->Data);
+    ImGuiStorage::ImGuiStoragePair* it = LowerBound(data, key);
+    if (it == data.end() || it->key != key)
+        return NULL;
+    return it;
+}
+
+// Returns the pair for new_pair.key, inserting new_pair when missing
+// FIXME-OPT: Sorted insertion moves every pair after it, O(N) per new key
+static ImGuiStorage::ImGuiStoragePair* ImGuiStorageFindOrInsertPair(ImGuiStorage* storage, const ImGuiStorage::ImGuiStoragePair& new_pair)
+{
+    ImGuiStorage::ImGuiStoragePair* it = LowerBound(storage->Data, new_pair.key);
+    if (it == storage->Data.end() || it->key != new_pair.key)
+        it = storage->Data.insert(it, new_pair);
+    return it;
+}
+
+#endif // #ifdef IMGUI_STORAGE_HASHMAP
+
 // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
 void ImGuiStorage::BuildSortByKey()
 {
@@ -2394,14 +2700,18 @@ void ImGuiStorage::BuildSortByKey()
         }
     };
     ImQsort(Data.Data, (size_t)Data.Size, sizeof(ImGuiStoragePair), StaticFunc::PairComparerByID);
+#ifdef IMGUI_STORAGE_HASHMAP
+    int index_size = 16;
+    while (index_size < Data.Size * 2)
+        index_size *= 2;
+    ImGuiStorageRebuildIndex(this, index_size);
+#endif
 }
 
 int ImGuiStorage::GetInt(ImGuiID key, int default_val) const
 {
-    ImGuiStoragePair* it = LowerBound(const_cast<ImVector<ImGuiStoragePair>&>(Data), key);
-    if (it == Data.end() || it->key != key)
-        return default_val;
-    return it->val_i;
+    ImGuiStoragePair* it = ImGuiStorageFindPair(this, key);
+    return it ? it->val_i : default_val;
 }
 
 bool ImGuiStorage::GetBool(ImGuiID key, bool default_val) const
@@ -2411,27 +2721,20 @@ bool ImGuiStorage::GetBool(ImGuiID key, bool default_val) const
 
 float ImGuiStorage::GetFloat(ImGuiID key, float default_val) const
 {
-    ImGuiStoragePair* it = LowerBound(const_cast<ImVector<ImGuiStoragePair>&>(Data), key);
-    if (it == Data.end() || it->key != key)
-        return default_val;
-    return it->val_f;
+    ImGuiStoragePair* it = ImGuiStorageFindPair(this, key);
+    return it ? it->val_f : default_val;
 }
 
 void* ImGuiStorage::GetVoidPtr(ImGuiID key) const
 {
-    ImGuiStoragePair* it = LowerBound(const_cast<ImVector<ImGuiStoragePair>&>(Data), key);
-    if (it == Data.end() || it->key != key)
-        return NULL;
-    return it->val_p;
+    ImGuiStoragePair* it = ImGuiStorageFindPair(this, key);
+    return it ? it->val_p : NULL;
 }
 
 // References are only valid until a new value is added to the storage. Calling a Set***() function or a Get***Ref() function invalidates the pointer.
 int* ImGuiStorage::GetIntRef(ImGuiID key, int default_val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_i;
+    return &ImGuiStorageFindOrInsertPair(this, ImGuiStoragePair(key, default_val))->val_i;
 }
 
 bool* ImGuiStorage::GetBoolRef(ImGuiID key, bool default_val)
@@ -2441,30 +2744,17 @@ bool* ImGuiStorage::GetBoolRef(ImGuiID key, bool default_val)
 
 float* ImGuiStorage::GetFloatRef(ImGuiID key, float default_val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_f;
+    return &ImGuiStorageFindOrInsertPair(this, ImGuiStoragePair(key, default_val))->val_f;
 }
 
 void** ImGuiStorage::GetVoidPtrRef(ImGuiID key, void* default_val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_p;
+    return &ImGuiStorageFindOrInsertPair(this, ImGuiStoragePair(key, default_val))->val_p;
 }
 
-// FIXME-OPT: Need a way to reuse the result of lower_bound when doing GetInt()/SetInt() - not too bad because it only happens on explicit interaction (maximum one a frame)
 void ImGuiStorage::SetInt(ImGuiID key, int val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-    {
-        Data.insert(it, ImGuiStoragePair(key, val));
-        return;
-    }
-    it->val_i = val;
+    ImGuiStorageFindOrInsertPair(this, ImGuiStoragePair(key, val))->val_i = val;
 }
 
 void ImGuiStorage::SetBool(ImGuiID key, bool val)
@@ -2474,24 +2764,12 @@ void ImGuiStorage::SetBool(ImGuiID key, bool val)
 
 void ImGuiStorage::SetFloat(ImGuiID key, float val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-    {
-        Data.insert(it, ImGuiStoragePair(key, val));
-        return;
-    }
-    it->val_f = val;
+    ImGuiStorageFindOrInsertPair(this, ImGuiStoragePair(key, val))->val_f = val;
 }
 
 void ImGuiStorage::SetVoidPtr(ImGuiID key, void* val)
 {
-    ImGuiStoragePair* it = LowerBound(Data, key);
-    if (it == Data.end() || it->key != key)
-    {
-        Data.insert(it, ImGuiStoragePair(key, val));
-        return;
-    }
-    it->val_p = val;
+    ImGuiStorageFindOrInsertPair(this, ImGuiStoragePair(key, val))->val_p = val;
 }
 
 void ImGuiStorage::SetAllInt(int v)
@@ -2666,6 +2944,54 @@ void ImGuiTextBuffer::appendfv(const char* fmt, va_list args)
     va_end(args_copy);
 }
 
+void* ImFrameArena::Alloc(size_t size)
+{
+    Buffer& buf = Buffers[Current];
+    size = IM_MEMALIGN(size, 16);
+    if (buf.Used + size <= buf.Capacity)
+    {
+        void* ptr = buf.Data + buf.Used;
+        buf.Used += size;
+        return ptr;
+    }
+    void* ptr = IM_ALLOC(size);
+    buf.Overflow.push_back(ptr);
+    buf.OverflowSize += size;
+    return ptr;
+}
+
+void ImFrameArena::NewFrame()
+{
+    Current ^= 1;
+    Buffer& buf = Buffers[Current];
+    if (buf.Overflow.Size > 0)
+    {
+        // Grow to fit everything the frame used, with some margin
+        const size_t frame_size = buf.Used + buf.OverflowSize;
+        for (void* ptr : buf.Overflow)
+            IM_FREE(ptr);
+        buf.Overflow.resize(0);
+        buf.OverflowSize = 0;
+        IM_FREE(buf.Data);
+        buf.Capacity = ImMax(frame_size + frame_size / 2, (size_t)IM_FRAME_ARENA_MIN_SIZE);
+        buf.Data = (char*)IM_ALLOC(buf.Capacity);
+    }
+    buf.Used = 0;
+}
+
+void ImFrameArena::ClearFreeMemory()
+{
+    for (Buffer& buf : Buffers)
+    {
+        for (void* ptr : buf.Overflow)
+            IM_FREE(ptr);
+        buf.Overflow.clear();
+        IM_FREE(buf.Data);
+        buf.Data = NULL;
+        buf.Capacity = buf.Used = buf.OverflowSize = 0;
+    }
+}
+
 void ImGuiTextIndex::append(const char* base, int old_size, int new_size)
 {
     IM_ASSERT(old_size >= 0 && new_size >= old_size && new_size >= EndOffset);
@@ -3624,6 +3950,11 @@ void ImGui::Shutdown()
     }
     g.IO.Fonts = NULL;
     g.DrawListSharedData.TempBuffer.clear();
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+    g.DrawListSharedData.TextLayoutCache = NULL;
+    g.TextLayoutCache.Clear();
+#endif
+    g.FrameArena.ClearFreeMemory();
 
     // Cleanup of other data are conditional on actually having initialized Dear ImGui.
     if (!g.Initialized)
@@ -3668,6 +3999,9 @@ void ImGui::Shutdown()
     g.TablesTempData.clear_destruct();
     g.DrawChannelsTempMergeBuffer.clear();
 
+    g.CurrentRetained = NULL;
+    g.Retained.Clear();
+
     g.ClipboardHandlerData.clear();
     g.MenusIdSubmittedThisFrame.clear();
     g.InputTextState.ClearFreeMemory();
@@ -4207,7 +4541,10 @@ float ImGui::CalcWrapWidthForPos(const ImVec2& pos, float wrap_pos_x)
 void* ImGui::MemAlloc(size_t size)
 {
     if (ImGuiContext* ctx = GImGui)
+    {
         ctx->IO.MetricsActiveAllocations++;
+        ctx->FrameAllocCount++;
+    }
     return (*GImAllocatorAllocFunc)(size, GImAllocatorUserData);
 }
 
@@ -4216,10 +4553,19 @@ void ImGui::MemFree(void* ptr)
 {
     if (ptr)
         if (ImGuiContext* ctx = GImGui)
+        {
             ctx->IO.MetricsActiveAllocations--;
+            ctx->FrameFreeCount++;
+        }
     return (*GImAllocatorFreeFunc)(ptr, GImAllocatorUserData);
 }
 
+void* ImGui::MemAllocFrame(size_t size)
+{
+    ImGuiContext& g = *GImGui;
+    return g.FrameArena.Alloc(size);
+}
+
 const char* ImGui::GetClipboardText()
 {
     ImGuiContext& g = *GImGui;
@@ -4530,6 +4876,9 @@ void ImGui::NewFrame()
     g.Time += g.IO.DeltaTime;
     g.WithinFrameScope = true;
     g.FrameCount += 1;
+    g.IO.MetricsFrameAllocations = g.FrameAllocCount;
+    g.IO.MetricsFrameFrees = g.FrameFreeCount;
+    g.FrameAllocCount = g.FrameFreeCount = 0;
     g.TooltipOverrideCount = 0;
     g.WindowsActiveCount = 0;
     g.MenusIdSubmittedThisFrame.resize(0);
@@ -4552,6 +4901,14 @@ void ImGui::NewFrame()
     g.IO.Fonts->Locked = true;
     SetCurrentFont(GetDefaultFont());
     IM_ASSERT(g.Font->IsLoaded());
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+    g.TextLayoutCache.FrameArena = &g.FrameArena;
+    g.TextLayoutCache.NewFrame(g.IO.Fonts);
+    g.DrawListSharedData.TextLayoutCache = &g.TextLayoutCache;
+#endif
+
+    // Recycle the frame arena buffer of two frames ago (after the text layout cache dropped what it had there)
+    g.FrameArena.NewFrame();
     ImRect virtual_space(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
     for (ImGuiViewportP* viewport : g.Viewports)
         virtual_space.Add(viewport->GetMainRect());
@@ -4736,6 +5093,18 @@ void ImGui::NewFrame()
     for (ImGuiTableTempData& table_temp_data : g.TablesTempData)
         if (table_temp_data.LastTimeActive >= 0.0f && table_temp_data.LastTimeActive < memory_compact_start_time)
             TableGcCompactTransientBuffers(&table_temp_data);
+
+    // Garbage collect recorded contents of recently unused retained regions
+    for (int i = 0; i < g.Retained.GetMapSize(); i++)
+        if (ImGuiRetainedData* retained = g.Retained.TryGetMapData(i))
+            if (retained->LastTimeActive >= 0.0f && retained->LastTimeActive < memory_compact_start_time)
+            {
+                retained->ClearFreeMemory();
+                retained->LastTimeActive = -1.0f;
+            }
+    g.RetainedReplayedCountLastFrame = g.RetainedReplayedCount;
+    g.RetainedRecordedCountLastFrame = g.RetainedRecordedCount;
+    g.RetainedReplayedCount = g.RetainedRecordedCount = 0;
     if (g.GcCompactAll)
         GcCompactTransientMiscBuffers();
     g.GcCompactAll = false;
@@ -5152,7 +5521,11 @@ ImVec2 ImGui::CalcTextSize(const char* text, const char* text_end, bool hide_tex
     const float font_size = g.FontSize;
     if (text == text_display_end)
         return ImVec2(0.0f, font_size);
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+    ImVec2 text_size = g.TextLayoutCache.CalcTextSize(font, font_size, wrap_width, text, text_display_end);
+#else
     ImVec2 text_size = font->CalcTextSizeA(font_size, FLT_MAX, wrap_width, text, text_display_end, NULL);
+#endif
 
     // Round
     // FIXME: This has been here since Dec 2015 (7b0bf230) but down the line we want this out.
@@ -6919,6 +7292,7 @@ void ImGui::End()
     // Error checking: verify that user doesn't directly call End() on a child window.
     if (window->Flags & ImGuiWindowFlags_ChildWindow)
         IM_ASSERT_USER_ERROR(g.WithinEndChild, "Must call EndChild() and not End()!");
+    IM_ASSERT_USER_ERROR(g.CurrentRetained == NULL || g.CurrentRetained->Window != window, "Missing EndRetained()");
 
     // Close anything that is open
     if (window->DC.CurrentColumns)
@@ -7200,6 +7574,197 @@ void ImGui::EndDisabled()
         g.Style.Alpha = g.DisabledAlphaBackup; //PopStyleVar();
 }
 
+// Contents which may react to input this frame are always rebuilt. Recording them in that state would also replay hovered/active visuals later.
+static bool IsRetainedRegionInteracting(ImGuiWindow* window, const ImRect& rect)
+{
+    ImGuiContext& g = *GImGui;
+    if (g.ActiveId != 0 && g.ActiveIdWindow == window)
+        return true;
+    if (g.OpenPopupStack.Size > 0 || g.DragDropActive)
+        return true;
+    if (g.NavWindow == window && (g.IO.ConfigFlags & (ImGuiConfigFlags_NavEnableKeyboard | ImGuiConfigFlags_NavEnableGamepad)))
+        return true;
+    if (g.HoveredWindow == window)
+    {
+        ImRect hover_rect = rect;
+        hover_rect.Expand(g.Style.ItemSpacing + g.Style.TouchExtraPadding);
+        if (hover_rect.Contains(g.IO.MousePos))
+            return true;
+    }
+    return false;
+}
+
+bool ImGui::BeginRetained(const char* str_id, ImGuiID state_hash)
+{
+    ImGuiContext& g = *GImGui;
+    ImGuiWindow* window = g.CurrentWindow;
+    IM_ASSERT(g.CurrentRetained == NULL && "Retained regions cannot be nested.");
+    if (window->SkipItems)
+        return false;
+
+    const ImGuiID id = window->GetID(str_id);
+    ImGuiRetainedData* retained = g.Retained.GetOrAddByKey(id);
+    retained->ID = id;
+    retained->Window = window;
+    retained->LastTimeActive = (float)g.Time;
+
+    // Everything the vertices and the layout of the contents depend on, besides the user state
+    ImDrawList* draw_list = window->DrawList;
+    struct
+    {
+        ImVec2          CursorPos;
+        ImVec2          CurrLineSize;
+        float           CurrLineTextBaseOffset;
+        float           Indent;
+        float           ItemWidth;
+        float           TextWrapPos;
+        ImRect          WorkRect;
+        ImRect          ContentRegionRect;
+        ImVec4          ClipRect;
+        ImTextureID     TextureId;
+        ImVec2          TexUvWhitePixel;
+        ImFont*         Font;
+        float           FontSize;
+        ImGuiItemFlags  ItemFlags;
+        int             CurrentTableIdx;
+        ImGuiID         StyleHash;
+        bool            IsSameLine;
+    } params;
+    memset(&params, 0, sizeof(params));
+    params.CursorPos = window->DC.CursorPos;
+    params.CurrLineSize = window->DC.CurrLineSize;
+    params.CurrLineTextBaseOffset = window->DC.CurrLineTextBaseOffset;
+    params.Indent = window->DC.Indent.x;
+    params.ItemWidth = window->DC.ItemWidth;
+    params.TextWrapPos = window->DC.TextWrapPos;
+    params.WorkRect = window->WorkRect;
+    params.ContentRegionRect = window->ContentRegionRect;
+    params.ClipRect = draw_list->_CmdHeader.ClipRect;
+    params.TextureId = draw_list->_CmdHeader.TextureId;
+    params.TexUvWhitePixel = g.DrawListSharedData.TexUvWhitePixel;
+    params.Font = g.Font;
+    params.FontSize = g.FontSize;
+    params.ItemFlags = g.CurrentItemFlags;
+    params.CurrentTableIdx = window->DC.CurrentTableIdx;
+    params.StyleHash = ImHashData(&g.Style, sizeof(g.Style));
+    params.IsSameLine = window->DC.IsSameLine;
+    const ImGuiID hash = ImHashData(&params, sizeof(params), state_hash);
+
+    const bool interacting = IsRetainedRegionInteracting(window, retained->Rect);
+    const bool fits = sizeof(ImDrawIdx) != 2 || draw_list->_VtxCurrentIdx + (unsigned int)retained->VtxBuffer.Size < (1 << 16);
+    retained->Splitter.Split(draw_list, 2);
+    retained->Splitter.SetCurrentChannel(draw_list, 1);
+
+    if (retained->Valid && retained->Hash == hash && !interacting && fits)
+    {
+        // Replay: channel 1 starts with a single empty command, replace it with the recorded ones and rebase the indices
+        const unsigned int vtx_start = draw_list->_VtxCurrentIdx;
+        const int cmd_count = retained->CmdBuffer.Size;
+        const int idx_count = retained->IdxBuffer.Size;
+        const int vtx_count = retained->VtxBuffer.Size;
+        draw_list->CmdBuffer.resize(cmd_count);
+        memcpy(draw_list->CmdBuffer.Data, retained->CmdBuffer.Data, (size_t)cmd_count * sizeof(ImDrawCmd));
+        for (ImDrawCmd& cmd : draw_list->CmdBuffer)
+            cmd.VtxOffset = draw_list->_CmdHeader.VtxOffset;
+        draw_list->IdxBuffer.resize(idx_count);
+        const ImDrawIdx idx_delta = (ImDrawIdx)(vtx_start - retained->VtxStartIdx);
+        for (int n = 0; n < idx_count; n++)
+            draw_list->IdxBuffer.Data[n] = (ImDrawIdx)(retained->IdxBuffer.Data[n] + idx_delta);
+        draw_list->VtxBuffer.resize(draw_list->VtxBuffer.Size + vtx_count);
+        memcpy(draw_list->VtxBuffer.Data + draw_list->VtxBuffer.Size - vtx_count, retained->VtxBuffer.Data, (size_t)vtx_count * sizeof(ImDrawVert));
+        draw_list->_VtxWritePtr = draw_list->VtxBuffer.Data + draw_list->VtxBuffer.Size;
+        draw_list->_IdxWritePtr = draw_list->IdxBuffer.Data + idx_count;
+        draw_list->_VtxCurrentIdx = vtx_start + (unsigned int)vtx_count;
+        retained->Splitter.Merge(draw_list);
+
+        window->DC.CursorPos = retained->CursorPos;
+        window->DC.CursorPosPrevLine = retained->CursorPosPrevLine;
+        window->DC.CursorMaxPos = ImMax(window->DC.CursorMaxPos, retained->CursorMaxPos);
+        window->DC.IdealMaxPos = ImMax(window->DC.IdealMaxPos, retained->IdealMaxPos);
+        window->DC.CurrLineSize = retained->CurrLineSize;
+        window->DC.PrevLineSize = retained->PrevLineSize;
+        window->DC.CurrLineTextBaseOffset = retained->CurrLineTextBaseOffset;
+        window->DC.PrevLineTextBaseOffset = retained->PrevLineTextBaseOffset;
+        window->DC.IsSameLine = retained->IsSameLine;
+        window->DC.IsSetPos = retained->IsSetPos;
+        window->DC.NavLayersActiveMaskNext |= retained->NavLayersActiveMaskNext;
+
+        // The region stands for its contents as the last item
+        g.LastItemData.ID = 0;
+        g.LastItemData.InFlags = ImGuiItemFlags_None;
+        g.LastItemData.StatusFlags = ImGuiItemStatusFlags_None;
+        g.LastItemData.Rect = g.LastItemData.NavRect = g.LastItemData.DisplayRect = retained->Rect;
+        g.RetainedReplayedCount++;
+        return false;
+    }
+
+    // Record, unless the state changed since last frame: contents that change every frame never pay for the copies
+    retained->Discard = interacting || retained->Hash != hash;
+    retained->Hash = hash;
+    retained->Valid = false;
+    retained->VtxStartIdx = draw_list->_VtxCurrentIdx;
+    retained->Rect.Min = window->DC.CursorPos;
+    retained->BackupCursorMaxPos = window->DC.CursorMaxPos;
+    retained->BackupIdealMaxPos = window->DC.IdealMaxPos;
+    retained->BackupNavLayersActiveMaskNext = window->DC.NavLayersActiveMaskNext;
+    retained->BackupVtxBufferSize = draw_list->VtxBuffer.Size;
+    retained->BackupVtxOffset = draw_list->_CmdHeader.VtxOffset;
+    retained->BackupChildWindowsCount = window->DC.ChildWindows.Size;
+    window->DC.CursorMaxPos = window->DC.IdealMaxPos = window->DC.CursorPos;
+    window->DC.NavLayersActiveMaskNext = 0;
+    g.CurrentRetained = retained;
+    g.RetainedRecordedCount++;
+    return true;
+}
+
+void ImGui::EndRetained()
+{
+    ImGuiContext& g = *GImGui;
+    ImGuiWindow* window = g.CurrentWindow;
+    ImGuiRetainedData* retained = g.CurrentRetained;
+    IM_ASSERT(retained != NULL && "Mismatched BeginRetained()/EndRetained() calls!");
+    IM_ASSERT(retained->Window == window && "EndRetained() must be called in the window which called BeginRetained()!");
+    ImDrawList* draw_list = window->DrawList;
+    IM_ASSERT(retained->Splitter._Current == 1);
+
+    retained->Rect.Max = ImMax(retained->Rect.Min, window->DC.CursorMaxPos);
+    bool keep = !retained->Discard && !IsRetainedRegionInteracting(window, retained->Rect);
+    keep &= window->DC.ChildWindows.Size == retained->BackupChildWindowsCount;
+    keep &= draw_list->_CmdHeader.VtxOffset == retained->BackupVtxOffset;
+    for (const ImDrawCmd& cmd : draw_list->CmdBuffer)
+        keep &= cmd.UserCallback == NULL;
+
+    if (keep)
+    {
+        const int vtx_count = draw_list->VtxBuffer.Size - retained->BackupVtxBufferSize;
+        retained->CmdBuffer.resize(draw_list->CmdBuffer.Size);
+        memcpy(retained->CmdBuffer.Data, draw_list->CmdBuffer.Data, (size_t)draw_list->CmdBuffer.Size * sizeof(ImDrawCmd));
+        retained->IdxBuffer.resize(draw_list->IdxBuffer.Size);
+        memcpy(retained->IdxBuffer.Data, draw_list->IdxBuffer.Data, (size_t)draw_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+        retained->VtxBuffer.resize(vtx_count);
+        memcpy(retained->VtxBuffer.Data, draw_list->VtxBuffer.Data + retained->BackupVtxBufferSize, (size_t)vtx_count * sizeof(ImDrawVert));
+
+        retained->CursorPos = window->DC.CursorPos;
+        retained->CursorPosPrevLine = window->DC.CursorPosPrevLine;
+        retained->CursorMaxPos = window->DC.CursorMaxPos;
+        retained->IdealMaxPos = window->DC.IdealMaxPos;
+        retained->CurrLineSize = window->DC.CurrLineSize;
+        retained->PrevLineSize = window->DC.PrevLineSize;
+        retained->CurrLineTextBaseOffset = window->DC.CurrLineTextBaseOffset;
+        retained->PrevLineTextBaseOffset = window->DC.PrevLineTextBaseOffset;
+        retained->IsSameLine = window->DC.IsSameLine;
+        retained->IsSetPos = window->DC.IsSetPos;
+        retained->NavLayersActiveMaskNext = window->DC.NavLayersActiveMaskNext;
+    }
+    retained->Valid = keep;
+    retained->Splitter.Merge(draw_list);
+
+    window->DC.CursorMaxPos = ImMax(retained->BackupCursorMaxPos, window->DC.CursorMaxPos);
+    window->DC.IdealMaxPos = ImMax(retained->BackupIdealMaxPos, window->DC.IdealMaxPos);
+    window->DC.NavLayersActiveMaskNext |= retained->BackupNavLayersActiveMaskNext;
+    g.CurrentRetained = NULL;
+}
+
 void ImGui::PushTabStop(bool tab_stop)
 {
     PushItemFlag(ImGuiItemFlags_NoTabStop, !tab_stop);
@@ -13671,6 +14236,7 @@ void ImGui::ShowMetricsWindow(bool* p_open)
     Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
     Text("%d vertices, %d indices (%d triangles)", io.MetricsRenderVertices, io.MetricsRenderIndices, io.MetricsRenderIndices / 3);
     Text("%d visible windows, %d active allocations", io.MetricsRenderWindows, io.MetricsActiveAllocations);
+    Text("Last frame: %d allocations, %d frees, %d KB in frame arena (%d KB reserved)", io.MetricsFrameAllocations, io.MetricsFrameFrees, (int)(g.FrameArena.GetLastFrameSize() / 1024), (int)(g.FrameArena.GetCapacity() / 1024));
     //SameLine(); if (SmallButton("GC")) { g.GcCompactAll = true; }
 
     Separator();
@@ -14109,6 +14675,19 @@ void ImGui::ShowMetricsWindow(bool* p_open)
         Text("NavWindowingTarget: '%s'", g.NavWindowingTarget ? g.NavWindowingTarget->Name : "NULL");
         Unindent();
 
+        Text("RETAINED REGIONS");
+        Indent();
+        Text("Regions: %d, last frame: %d replayed, %d recorded", g.Retained.GetAliveCount(), g.RetainedReplayedCountLastFrame, g.RetainedRecordedCountLastFrame);
+        Unindent();
+
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+        Text("TEXT LAYOUT CACHE");
+        Indent();
+        Text("Layouts: %d, Generation: %d", g.TextLayoutCache.Layouts.Size, g.TextLayoutCache.Generation);
+        Text("Last frame: %d hits, %d misses", g.TextLayoutCache.HitsLastFrame, g.TextLayoutCache.MissesLastFrame);
+        Unindent();
+#endif
+
         TreePop();
     }
 
@@ -14413,7 +14992,12 @@ void ImGui::DebugNodeFontGlyph(ImFont*, const ImFontGlyph* glyph)
 // [DEBUG] Display contents of ImGuiStorage
 void ImGui::DebugNodeStorage(ImGuiStorage* storage, const char* label)
 {
-    if (!TreeNode(label, "%s: %d entries, %d bytes", label, storage->Data.Size, storage->Data.size_in_bytes()))
+#ifdef IMGUI_STORAGE_HASHMAP
+    const int storage_bytes = storage->Data.size_in_bytes() + storage->Index.size_in_bytes();
+#else
+    const int storage_bytes = storage->Data.size_in_bytes();
+#endif
+    if (!TreeNode(label, "%s: %d entries, %d bytes", label, storage->Data.Size, storage_bytes))
         return;
     for (const ImGuiStorage::ImGuiStoragePair& p : storage->Data)
         BulletText("Key 0x%08X Value { i: %d }", p.key, p.val_i); // Important: we currently don't store a type, real value may not be integer.
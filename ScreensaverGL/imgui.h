@@ -837,6 +837,14 @@ namespace ImGui
     IMGUI_API void          BeginDisabled(bool disabled = true);
     IMGUI_API void          EndDisabled();
 
+    // Retained regions
+    // - Skip rebuilding a part of the current window while it cannot have changed: pass a hash of all the state the contents depend on.
+    // - BeginRetained() returns false when the draw commands and layout recorded last time were reused: skip the contents and don't call EndRetained().
+    // - Contents are rebuilt (and recorded again) while the mouse is over them, an item of the window is active, a popup is open or keyboard/gamepad navigation is on the window.
+    // - Only the window draw list is recorded. Child windows inside prevent recording and regions cannot be nested.
+    IMGUI_API bool          BeginRetained(const char* str_id, ImGuiID state_hash);
+    IMGUI_API void          EndRetained();                                  // only call EndRetained() if BeginRetained() returns true!
+
     // Clipping
     // - Mouse hovering is affected by ImGui::PushClipRect() calls, unlike direct calls to ImDrawList::PushClipRect() which are render only.
     IMGUI_API void          PushClipRect(const ImVec2& clip_rect_min, const ImVec2& clip_rect_max, bool intersect_with_current_clip_rect);
@@ -961,6 +969,7 @@ namespace ImGui
     IMGUI_API void          GetAllocatorFunctions(ImGuiMemAllocFunc* p_alloc_func, ImGuiMemFreeFunc* p_free_func, void** p_user_data);
     IMGUI_API void*         MemAlloc(size_t size);
     IMGUI_API void          MemFree(void* ptr);
+    IMGUI_API void*         MemAllocFrame(size_t size);                     // Uses the current context. Valid until the end of the next frame, no need to free: NewFrame() recycles the memory of the frame before.
 
 } // namespace ImGui
 
@@ -2090,6 +2099,8 @@ struct ImGuiIO
     int         MetricsRenderWindows;               // Number of visible windows
     int         MetricsActiveWindows;               // Number of active windows
     int         MetricsActiveAllocations;           // Number of active allocations, updated by MemAlloc/MemFree based on current context. May be off if you have multiple imgui contexts.
+    int         MetricsFrameAllocations;            // Number of MemAlloc() calls during the previous frame (from one NewFrame() to the next).
+    int         MetricsFrameFrees;                  // Number of MemFree() calls during the previous frame.
     ImVec2      MouseDelta;                         // Mouse delta. Note that this is zero if either current or previous position are invalid (-FLT_MAX,-FLT_MAX), so a disappearing/reappearing mouse won't have a huge delta.
 
     // Legacy: before 1.87, we required backend to fill io.KeyMap[] (imgui->native map) during initialization and io.KeysDown[] (native indices) every frame.
@@ -2320,6 +2331,7 @@ struct ImGuiTextBuffer
 // Typically you don't have to worry about this since a storage is held within each Window.
 // We use it to e.g. store collapse state for a tree (Int 0/1)
 // This is optimized for efficient lookup (dichotomy into a contiguous buffer) and rare insertion (typically tied to user interactions aka max once a frame)
+// With IMGUI_STORAGE_HASHMAP (see imconfig.h) pairs are kept in insertion order and found through an open addressing index instead, so inserting is O(1).
 // You can use it as custom user storage for temporary values. Declare your own storage if, for example:
 // - You want to manipulate the open/close state of a particular sub-tree in your interface (tree node uses Int 0/1 to store their state).
 // - You want to store custom debug data easily without adding or editing structures in your code (probably not efficient, but convenient)
@@ -2337,11 +2349,19 @@ struct ImGuiStorage
     };
 
     ImVector<ImGuiStoragePair>      Data;
+#ifdef IMGUI_STORAGE_HASHMAP
+    ImVector<int>                   Index;  // Slot -> index into Data, -1 when empty. Power of two size, kept at most half full.
+#endif
 
     // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N)
     // - Set***() functions find pair, insertion on demand if missing.
     // - Sorted insertion is costly, paid once. A typical frame shouldn't need to insert any new pair.
+    // - With IMGUI_STORAGE_HASHMAP queries and insertions are O(1) on average. Call BuildSortByKey() after writing to Data directly.
+#ifdef IMGUI_STORAGE_HASHMAP
+    void                Clear() { Data.clear(); Index.clear(); }
+#else
     void                Clear() { Data.clear(); }
+#endif
     IMGUI_API int       GetInt(ImGuiID key, int default_val = 0) const;
     IMGUI_API void      SetInt(ImGuiID key, int val);
     IMGUI_API bool      GetBool(ImGuiID key, bool default_val = false) const;
@@ -2364,6 +2384,7 @@ struct ImGuiStorage
     IMGUI_API void      SetAllInt(int val);
 
     // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
+    // With IMGUI_STORAGE_HASHMAP this also rebuilds the index. Keys have to be unique.
     IMGUI_API void      BuildSortByKey();
 };
 
@@ -2851,6 +2872,23 @@ enum ImFontAtlasFlags_
     ImFontAtlasFlags_NoBakedLines       = 1 << 2,   // Don't build thick line textures into the atlas (save a little texture memory, allow support for point/nearest filtering). The AntiAliasedLinesUseTex features uses them, otherwise they will be rendered using polygons (more expensive for CPU/GPU).
 };
 
+// Runs func(data, begin, end) over chunks covering [0, count) and returns once every chunk is done. Chunks may run on any thread, in any order.
+// Set ImFontAtlas::ParallelFor to rasterize glyphs on your own worker threads (stb_truetype builder only).
+typedef void (*ImFontAtlasParallelFor)(int count, void (*func)(void* data, int begin, int end), void* data, void* user_data);
+
+// Time spent in each phase of the last ImFontAtlas::Build(), in milliseconds (stb_truetype builder only)
+struct ImFontAtlasBuildTimings
+{
+    float   Gather;         // Load font data, find the requested glyphs and measure their rects
+    float   Pack;           // Pack glyph and custom rects into the texture
+    float   Rasterize;      // Render glyphs into the texture and apply RasterizerMultiply
+    float   Setup;          // Register glyphs into their ImFont, render custom rects
+    float   Total;
+    int     GlyphCount;
+    int     RasterTasks;    // Chunks of glyphs handed to ParallelFor, or rasterized in a row without it
+    bool    Parallel;
+};
+
 // Load and rasterize multiple TTF/OTF fonts into a same texture. The font atlas will build a single texture holding:
 //  - One or more fonts.
 //  - Custom graphics data needed to render the shapes needed by Dear ImGui.
@@ -2941,6 +2979,9 @@ struct ImFontAtlas
     int                         TexGlyphPadding;    // Padding between glyphs within texture in pixels. Defaults to 1. If your rendering method doesn't rely on bilinear filtering you may set this to 0 (will also need to set AntiAliasedLinesUseTex = false).
     bool                        Locked;             // Marked as Locked by ImGui::NewFrame() so attempt to modify the atlas will assert.
     void*                       UserData;           // Store your own atlas related user-data (if e.g. you have multiple font atlas).
+    ImFontAtlasParallelFor      ParallelFor;        // Optional: rasterize glyphs in parallel through this during Build(). Glyph rects never overlap, so chunks can run concurrently.
+    void*                       ParallelForUserData;// Passed to ParallelFor.
+    ImFontAtlasBuildTimings     BuildTimings;       // Phase timings of the last Build().
 
     // [Internal]
     // NB: Access texture data via GetTexData*() calls! Which will setup a default font for you.
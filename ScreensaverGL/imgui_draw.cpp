@@ -16,6 +16,7 @@ Index of this file:
 // [SECTION] ImFontAtlas glyph ranges helpers
 // [SECTION] ImFontGlyphRangesBuilder
 // [SECTION] ImFont
+// [SECTION] ImTextLayoutCache
 // [SECTION] ImGui Internal Render Helpers
 // [SECTION] Decompression code
 // [SECTION] Default font data (ProggyClean.ttf)
@@ -38,6 +39,7 @@ Index of this file:
 #endif
 
 #include <stdio.h>      // vsnprintf, sscanf, printf
+#include <chrono>       // steady_clock, font atlas build timings
 
 // Visual Studio warnings
 #ifdef _MSC_VER
@@ -128,8 +130,22 @@ namespace IMGUI_STB_NAMESPACE
 #ifdef  IMGUI_ENABLE_STB_TRUETYPE
 #ifndef STB_TRUETYPE_IMPLEMENTATION                         // in case the user already have an implementation in the _same_ compilation unit (e.g. unity builds)
 #ifndef IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION           // in case the user already have an implementation in another compilation unit
-#define STBTT_malloc(x,u)   ((void)(u), IM_ALLOC(x))
-#define STBTT_free(x,u)     ((void)(u), IM_FREE(x))
+// Rasterizer tasks may run on other threads and mark their font info with a non-NULL userdata. They allocate through the allocator
+// functions directly since IM_ALLOC() also counts allocations in the current context, without synchronization.
+static void* ImFontAtlasBuildThreadAlloc(size_t size)
+{
+    ImGuiMemAllocFunc alloc_func; ImGuiMemFreeFunc free_func; void* user_data;
+    ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &user_data);
+    return alloc_func(size, user_data);
+}
+static void ImFontAtlasBuildThreadFree(void* ptr)
+{
+    ImGuiMemAllocFunc alloc_func; ImGuiMemFreeFunc free_func; void* user_data;
+    ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &user_data);
+    free_func(ptr, user_data);
+}
+#define STBTT_malloc(x,u)   ((u) ? ImFontAtlasBuildThreadAlloc(x) : IM_ALLOC(x))
+#define STBTT_free(x,u)     ((u) ? ImFontAtlasBuildThreadFree(x) : IM_FREE(x))
 #define STBTT_assert(x)     do { IM_ASSERT(x); } while(0)
 #define STBTT_fmod(x,y)     ImFmod(x,y)
 #define STBTT_sqrt(x)       ImSqrt(x)
@@ -1587,6 +1603,11 @@ void ImDrawList::AddText(const ImFont* font, float font_size, const ImVec2& pos,
 
     IM_ASSERT(font->ContainerAtlas->TexID == _CmdHeader.TextureId);  // Use high-level ImGui::PushFont() or low-level ImDrawList::PushTextureId() to change font.
 
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+    if (cpu_fine_clip_rect == NULL && _Data->TextLayoutCache != NULL && _Data->TextLayoutCache->AddText(this, font, font_size, pos, col, _CmdHeader.ClipRect, text_begin, text_end, wrap_width))
+        return;
+#endif
+
     ImVec4 clip_rect = _CmdHeader.ClipRect;
     if (cpu_fine_clip_rect)
     {
@@ -2389,10 +2410,76 @@ static void UnpackBitVectorToFlatIndexList(const ImBitVector* in, ImVector<int>*
                     out->push_back((int)(((it - it_begin) << 5) + bit_n));
 }
 
+// Glyphs per rasterizer task. Small enough to balance big CJK ranges across threads, large enough to keep the per task overhead low.
+#define IM_FONT_BUILD_RASTER_CHUNK 128
+
+struct ImFontBuildRasterTask
+{
+    int                 SrcIndex;
+    int                 GlyphBegin;
+    int                 GlyphCount;
+};
+
+struct ImFontBuildRasterData
+{
+    ImFontAtlas*            Atlas;
+    const stbtt_pack_context* PackContext;
+    ImFontBuildSrcData*     SrcArray;
+    ImFontBuildRasterTask*  Tasks;
+};
+
+static double ImFontAtlasBuildGetTime()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Every task writes its own glyph rects and packed chars, so tasks can run concurrently
+static void ImFontAtlasBuildRasterizeTasks(void* data_p, int task_begin, int task_end)
+{
+    static int thread_alloc_marker;
+    ImFontBuildRasterData* data = (ImFontBuildRasterData*)data_p;
+    ImFontAtlas* atlas = data->Atlas;
+
+    // stbtt_PackFontRangesRenderIntoRects() changes the oversampling of the context while it runs, so every call gets its own copy
+    stbtt_pack_context spc = *data->PackContext;
+    for (int task_i = task_begin; task_i < task_end; task_i++)
+    {
+        const ImFontBuildRasterTask& task = data->Tasks[task_i];
+        const ImFontBuildSrcData& src_tmp = data->SrcArray[task.SrcIndex];
+        const ImFontConfig& cfg = atlas->ConfigData[task.SrcIndex];
+
+        stbtt_fontinfo font_info = src_tmp.FontInfo;
+        if (atlas->ParallelFor)
+            font_info.userdata = &thread_alloc_marker;
+
+        stbtt_pack_range range = src_tmp.PackRange;
+        range.array_of_unicode_codepoints += task.GlyphBegin;
+        range.chardata_for_range += task.GlyphBegin;
+        range.num_chars = task.GlyphCount;
+        stbrp_rect* rects = src_tmp.Rects + task.GlyphBegin;
+        stbtt_PackFontRangesRenderIntoRects(&spc, &font_info, &range, 1, rects);
+
+        // Apply multiply operator
+        if (cfg.RasterizerMultiply != 1.0f)
+        {
+            unsigned char multiply_table[256];
+            ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+            stbrp_rect* r = rects;
+            for (int glyph_i = 0; glyph_i < task.GlyphCount; glyph_i++, r++)
+                if (r->was_packed)
+                    ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, atlas->TexWidth * 1);
+        }
+    }
+}
+
 static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
 {
     IM_ASSERT(atlas->ConfigData.Size > 0);
 
+    ImFontAtlasBuildTimings& timings = atlas->BuildTimings;
+    memset(&timings, 0, sizeof(timings));
+    const double time_start = ImFontAtlasBuildGetTime();
+
     ImFontAtlasBuildInit(atlas);
 
     // Clear atlas
@@ -2536,6 +2623,10 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
         }
     }
 
+    timings.GlyphCount = total_glyphs_count;
+    const double time_gathered = ImFontAtlasBuildGetTime();
+    timings.Gather = (float)(time_gathered - time_start);
+
     // We need a width for the skyline algorithm, any width!
     // The exact width doesn't really matter much, but some API/GPU have texture size limitations and increasing width can decrease height.
     // User can override TexDesiredWidth and TexGlyphPadding if they wish, otherwise we use a simple heuristic to select the width based on expected surface.
@@ -2569,6 +2660,9 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
                 atlas->TexHeight = ImMax(atlas->TexHeight, src_tmp.Rects[glyph_i].y + src_tmp.Rects[glyph_i].h);
     }
 
+    const double time_packed = ImFontAtlasBuildGetTime();
+    timings.Pack = (float)(time_packed - time_gathered);
+
     // 7. Allocate texture
     atlas->TexHeight = (atlas->Flags & ImFontAtlasFlags_NoPowerOfTwoHeight) ? (atlas->TexHeight + 1) : ImUpperPowerOfTwo(atlas->TexHeight);
     atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
@@ -2578,27 +2672,35 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     spc.height = atlas->TexHeight;
 
     // 8. Render/rasterize font characters into the texture
+    // Packing placed every glyph in its own rect, so chunks of glyphs can be rasterized in parallel when ParallelFor is set.
+    ImVector<ImFontBuildRasterTask> raster_tasks;
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
-    {
-        ImFontConfig& cfg = atlas->ConfigData[src_i];
-        ImFontBuildSrcData& src_tmp = src_tmp_array[src_i];
-        if (src_tmp.GlyphsCount == 0)
-            continue;
-
-        stbtt_PackFontRangesRenderIntoRects(&spc, &src_tmp.FontInfo, &src_tmp.PackRange, 1, src_tmp.Rects);
-
-        // Apply multiply operator
-        if (cfg.RasterizerMultiply != 1.0f)
+        for (int glyph_i = 0; glyph_i < src_tmp_array[src_i].GlyphsCount; glyph_i += IM_FONT_BUILD_RASTER_CHUNK)
         {
-            unsigned char multiply_table[256];
-            ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
-            stbrp_rect* r = &src_tmp.Rects[0];
-            for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i++, r++)
-                if (r->was_packed)
-                    ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, atlas->TexWidth * 1);
+            ImFontBuildRasterTask task;
+            task.SrcIndex = src_i;
+            task.GlyphBegin = glyph_i;
+            task.GlyphCount = ImMin(IM_FONT_BUILD_RASTER_CHUNK, src_tmp_array[src_i].GlyphsCount - glyph_i);
+            raster_tasks.push_back(task);
         }
-        src_tmp.Rects = NULL;
-    }
+
+    ImFontBuildRasterData raster_data;
+    raster_data.Atlas = atlas;
+    raster_data.PackContext = &spc;
+    raster_data.SrcArray = src_tmp_array.Data;
+    raster_data.Tasks = raster_tasks.Data;
+    timings.RasterTasks = raster_tasks.Size;
+    timings.Parallel = atlas->ParallelFor != NULL && raster_tasks.Size > 1;
+    if (timings.Parallel)
+        atlas->ParallelFor(raster_tasks.Size, ImFontAtlasBuildRasterizeTasks, &raster_data, atlas->ParallelForUserData);
+    else
+        ImFontAtlasBuildRasterizeTasks(&raster_data, 0, raster_tasks.Size);
+
+    for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
+        src_tmp_array[src_i].Rects = NULL;
+
+    const double time_rasterized = ImFontAtlasBuildGetTime();
+    timings.Rasterize = (float)(time_rasterized - time_packed);
 
     // End packing
     stbtt_PackEnd(&spc);
@@ -2640,6 +2742,10 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     src_tmp_array.clear_destruct();
 
     ImFontAtlasBuildFinish(atlas);
+
+    const double time_end = ImFontAtlasBuildGetTime();
+    timings.Setup = (float)(time_end - time_rasterized);
+    timings.Total = (float)(time_end - time_start);
     return true;
 }
 
@@ -3516,6 +3622,50 @@ const char* ImFont::CalcWordWrapPositionA(float scale, const char* text, const c
     return s;
 }
 
+#if defined(IMGUI_ENABLE_SSE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMGUI_ENABLE_SSE2_TEXT
+#endif
+
+static inline int ImCountTrailingZeros32(ImU32 v)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return (int)index;
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+// End of the run of printable ASCII (0x20..0x7F) starting at s, classifying 32 or 16 bytes at a time when SIMD is available.
+// Those bytes are their own codepoint and never a line break, so text layout can skip the UTF-8 decoder and control character checks.
+static inline const char* ImTextFindAsciiRunEnd(const char* s, const char* text_end)
+{
+#if defined(IMGUI_ENABLE_SSE) && defined(__AVX2__)
+    const __m256i limit_32 = _mm256_set1_epi8(0x1F);
+    while (text_end - s >= 32)
+    {
+        const ImU32 mask = (ImU32)_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_loadu_si256((const __m256i*)(const void*)s), limit_32));
+        if (mask != 0xFFFFFFFF)
+            return s + ImCountTrailingZeros32(~mask);
+        s += 32;
+    }
+#endif
+#ifdef IMGUI_ENABLE_SSE2_TEXT
+    const __m128i limit_16 = _mm_set1_epi8(0x1F);
+    while (text_end - s >= 16)
+    {
+        const ImU32 mask = (ImU32)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_loadu_si128((const __m128i*)(const void*)s), limit_16));
+        if (mask != 0xFFFF)
+            return s + ImCountTrailingZeros32(~mask);
+        s += 16;
+    }
+#endif
+    while (s < text_end && (signed char)*s > 0x1F)
+        s++;
+    return s;
+}
+
 ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, const char* text_begin, const char* text_end, const char** remaining) const
 {
     if (!text_end)
@@ -3529,6 +3679,7 @@ ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, cons
 
     const bool word_wrap_enabled = (wrap_width > 0.0f);
     const char* word_wrap_eol = NULL;
+    const bool ascii_fast_path = IndexAdvanceX.Size >= 0x80;
 
     const char* s = text_begin;
     while (s < text_end)
@@ -3551,6 +3702,23 @@ ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, cons
             }
         }
 
+        // Printable ASCII run: same sums in the same order as below, without decoding or checking every character
+        if (ascii_fast_path && (signed char)*s > 0x1F)
+        {
+            const char* run_end = ImTextFindAsciiRunEnd(s, word_wrap_enabled ? word_wrap_eol : text_end);
+            const float* advances = IndexAdvanceX.Data;
+            for (; s < run_end; s++)
+            {
+                const float char_width = advances[(unsigned char)*s] * scale;
+                if (line_width + char_width >= max_width)
+                    break;
+                line_width += char_width;
+            }
+            if (s < run_end)
+                break;
+            continue;
+        }
+
         // Decode and advance source
         const char* prev_s = s;
         unsigned int c = (unsigned int)*s;
@@ -3675,6 +3843,7 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
 
     const ImU32 col_untinted = col | ~IM_COL32_A_MASK;
     const char* word_wrap_eol = NULL;
+    const bool ascii_fast_path = !cpu_fine_clip && IndexLookup.Size >= 0x80;
 
     while (s < text_end)
     {
@@ -3694,6 +3863,49 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
             }
         }
 
+        // Printable ASCII run: emit quads straight into the reserved span without decoding or checking every character.
+        // Same math as the generic path below, minus the CPU fine clipping which takes the generic path.
+        if (ascii_fast_path && (signed char)*s > 0x1F)
+        {
+            const char* run_end = ImTextFindAsciiRunEnd(s, word_wrap_enabled ? word_wrap_eol : text_end);
+            const ImWchar* index_lookup = IndexLookup.Data;
+            for (; s < run_end; s++)
+            {
+                const ImWchar glyph_index = index_lookup[(unsigned char)*s];
+                const ImFontGlyph* glyph = (glyph_index == (ImWchar)-1) ? FallbackGlyph : &Glyphs.Data[glyph_index];
+                if (glyph == NULL)
+                    continue;
+
+                float char_width = glyph->AdvanceX * scale;
+                if (glyph->Visible)
+                {
+                    float x1 = x + glyph->X0 * scale;
+                    float x2 = x + glyph->X1 * scale;
+                    if (x1 <= clip_rect.z && x2 >= clip_rect.x)
+                    {
+                        float y1 = y + glyph->Y0 * scale;
+                        float y2 = y + glyph->Y1 * scale;
+                        float u1 = glyph->U0;
+                        float v1 = glyph->V0;
+                        float u2 = glyph->U1;
+                        float v2 = glyph->V1;
+                        ImU32 glyph_col = glyph->Colored ? col_untinted : col;
+                        vtx_write[0].pos.x = x1; vtx_write[0].pos.y = y1; vtx_write[0].col = glyph_col; vtx_write[0].uv.x = u1; vtx_write[0].uv.y = v1;
+                        vtx_write[1].pos.x = x2; vtx_write[1].pos.y = y1; vtx_write[1].col = glyph_col; vtx_write[1].uv.x = u2; vtx_write[1].uv.y = v1;
+                        vtx_write[2].pos.x = x2; vtx_write[2].pos.y = y2; vtx_write[2].col = glyph_col; vtx_write[2].uv.x = u2; vtx_write[2].uv.y = v2;
+                        vtx_write[3].pos.x = x1; vtx_write[3].pos.y = y2; vtx_write[3].col = glyph_col; vtx_write[3].uv.x = u1; vtx_write[3].uv.y = v2;
+                        idx_write[0] = (ImDrawIdx)(vtx_index); idx_write[1] = (ImDrawIdx)(vtx_index + 1); idx_write[2] = (ImDrawIdx)(vtx_index + 2);
+                        idx_write[3] = (ImDrawIdx)(vtx_index); idx_write[4] = (ImDrawIdx)(vtx_index + 2); idx_write[5] = (ImDrawIdx)(vtx_index + 3);
+                        vtx_write += 4;
+                        vtx_index += 4;
+                        idx_write += 6;
+                    }
+                }
+                x += char_width;
+            }
+            continue;
+        }
+
         // Decode and advance source
         unsigned int c = (unsigned int)*s;
         if (c < 0x80)
@@ -3794,6 +4006,225 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
     draw_list->_VtxCurrentIdx = vtx_index;
 }
 
+//-----------------------------------------------------------------------------
+// [SECTION] ImTextLayoutCache
+//-----------------------------------------------------------------------------
+
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+
+static void ImTextLayoutDestroy(ImTextLayout* layout)
+{
+    const bool in_frame_arena = layout->InFrameArena;
+    layout->~ImTextLayout();
+    if (!in_frame_arena)
+        IM_FREE(layout);
+}
+
+static inline bool ImTextLayoutMatches(const ImTextLayout* layout, const ImFont* font, float font_size, float wrap_width, const char* text, int text_len)
+{
+    return layout->Font == font && layout->FontSize == font_size && layout->WrapWidth == wrap_width && layout->TextLen == text_len && memcmp(layout->GetText(), text, (size_t)text_len) == 0;
+}
+
+void ImTextLayoutCache::Clear()
+{
+    for (ImTextLayout* layout : Layouts)
+        ImTextLayoutDestroy(layout);
+    Layouts.clear();
+    Map.Clear();
+    LastLayout = NULL;
+    if (ScratchDrawList)
+        IM_DELETE(ScratchDrawList);
+    ScratchDrawList = NULL;
+}
+
+void ImTextLayoutCache::NewFrame(ImFontAtlas* atlas)
+{
+    // Quads hold atlas UVs, a rebuilt atlas invalidates all of them
+    if (TexID != atlas->TexID || TexUvWhitePixel.x != atlas->TexUvWhitePixel.x || TexUvWhitePixel.y != atlas->TexUvWhitePixel.y)
+    {
+        Clear();
+        TexID = atlas->TexID;
+        TexUvWhitePixel = atlas->TexUvWhitePixel;
+    }
+
+    HitsLastFrame = Hits;
+    MissesLastFrame = Misses;
+    Hits = Misses = 0;
+    Generation++;
+
+    // Layouts still in the frame arena were not seen again the frame after they were created, their arena buffer is about to be recycled
+    int alive_count = 0;
+    for (ImTextLayout* layout : Layouts)
+    {
+        const bool expired = layout->InFrameArena ? (Generation - layout->CreatedGeneration >= 2) : (Generation - layout->LastUsedGeneration > IM_TEXT_LAYOUT_CACHE_MAX_AGE);
+        if (expired)
+            ImTextLayoutDestroy(layout);
+        else
+            Layouts[alive_count++] = layout;
+    }
+    if (alive_count == Layouts.Size)
+        return;
+
+    // Rebuild the map in one go, ImGuiStorage cannot remove keys
+    Layouts.resize(alive_count);
+    LastLayout = NULL;
+    Map.Data.resize(0);
+    Map.Data.reserve(alive_count);
+    for (int n = 0; n < alive_count; n++)
+        Map.Data.push_back(ImGuiStorage::ImGuiStoragePair(Layouts[n]->Key, n));
+    Map.BuildSortByKey();
+}
+
+ImTextLayout* ImTextLayoutCache::PromoteLayout(ImTextLayout* layout)
+{
+    IM_ASSERT(layout->InFrameArena && layout->Vtx.Data == NULL);
+    const size_t layout_size = sizeof(ImTextLayout) + (size_t)layout->TextLen;
+    ImTextLayout* heap_layout = (ImTextLayout*)IM_ALLOC(layout_size);
+    memcpy((void*)heap_layout, (const void*)layout, layout_size);
+    heap_layout->InFrameArena = false;
+    Layouts[Map.GetInt(layout->Key)] = heap_layout;
+    if (LastLayout == layout)
+        LastLayout = heap_layout;
+    return heap_layout;
+}
+
+ImTextLayout* ImTextLayoutCache::GetLayout(const ImFont* font, float font_size, float wrap_width, const char* text_begin, const char* text_end)
+{
+    const int text_len = (int)(text_end - text_begin);
+    if (text_len <= 0 || text_len > IM_TEXT_LAYOUT_CACHE_MAX_LENGTH)
+        return NULL;
+    if (LastLayout && ImTextLayoutMatches(LastLayout, font, font_size, wrap_width, text_begin, text_len))
+    {
+        ImTextLayout* layout = (LastLayout->InFrameArena && LastLayout->CreatedGeneration != Generation) ? PromoteLayout(LastLayout) : LastLayout;
+        layout->LastUsedGeneration = Generation;
+        return layout;
+    }
+
+    struct { const ImFont* Font; float FontSize; float WrapWidth; } params = { font, font_size, wrap_width };
+    const ImGuiID key = ImHashData(&params, sizeof(params), ImHashData(text_begin, (size_t)text_len, 0));
+    const int idx = Map.GetInt(key, -1);
+    if (idx != -1)
+    {
+        // On a hash collision the text already cached keeps the slot
+        ImTextLayout* layout = Layouts[idx];
+        if (!ImTextLayoutMatches(layout, font, font_size, wrap_width, text_begin, text_len))
+            return NULL;
+        if (layout->InFrameArena && layout->CreatedGeneration != Generation)
+            layout = PromoteLayout(layout);
+        layout->LastUsedGeneration = Generation;
+        LastLayout = layout;
+        return layout;
+    }
+
+    const size_t layout_size = sizeof(ImTextLayout) + (size_t)text_len;
+    ImTextLayout* layout = IM_PLACEMENT_NEW(FrameArena ? FrameArena->Alloc(layout_size) : IM_ALLOC(layout_size)) ImTextLayout();
+    layout->InFrameArena = (FrameArena != NULL);
+    layout->Key = key;
+    layout->Font = font;
+    layout->FontSize = font_size;
+    layout->WrapWidth = wrap_width;
+    layout->TextLen = text_len;
+    memcpy((char*)(layout + 1), text_begin, (size_t)text_len);
+    layout->CreatedGeneration = layout->LastUsedGeneration = Generation;
+    layout->HasSize = layout->HasVtx = false;
+    Map.SetInt(key, Layouts.Size);
+    Layouts.push_back(layout);
+    LastLayout = layout;
+    return layout;
+}
+
+ImVec2 ImTextLayoutCache::CalcTextSize(const ImFont* font, float font_size, float wrap_width, const char* text_begin, const char* text_end)
+{
+    ImTextLayout* layout = GetLayout(font, font_size, wrap_width, text_begin, text_end);
+    if (layout == NULL)
+    {
+        Misses++;
+        return font->CalcTextSizeA(font_size, FLT_MAX, wrap_width, text_begin, text_end, NULL);
+    }
+    if (layout->HasSize)
+    {
+        Hits++;
+        return layout->Size;
+    }
+    Misses++;
+    layout->Size = font->CalcTextSizeA(font_size, FLT_MAX, wrap_width, text_begin, text_end, NULL);
+    layout->HasSize = true;
+    return layout->Size;
+}
+
+bool ImTextLayoutCache::AddText(ImDrawList* draw_list, const ImFont* font, float font_size, const ImVec2& pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, float wrap_width)
+{
+    ImTextLayout* layout = GetLayout(font, font_size, wrap_width, text_begin, text_end);
+    if (layout == NULL || (!layout->HasVtx && layout->CreatedGeneration == Generation))
+    {
+        Misses++;
+        return false;
+    }
+
+    if (layout->HasVtx)
+    {
+        Hits++;
+    }
+    else
+    {
+        // Lay the text out once at the origin without clipping. A zero color leaves col at 0 for tinted glyphs and ~IM_COL32_A_MASK for colored ones.
+        Misses++;
+        if (ScratchDrawList == NULL)
+            ScratchDrawList = IM_NEW(ImDrawList)(draw_list->_Data);
+        ImDrawList* scratch = ScratchDrawList;
+        scratch->_Data = draw_list->_Data;
+        scratch->_ResetForNewFrame();
+        font->RenderText(scratch, font_size, ImVec2(0.0f, 0.0f), 0, ImVec4(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX), text_begin, text_end, wrap_width, false);
+
+        layout->Vtx.resize(scratch->VtxBuffer.Size);
+        if (scratch->VtxBuffer.Size > 0)
+            memcpy(layout->Vtx.Data, scratch->VtxBuffer.Data, (size_t)scratch->VtxBuffer.Size * sizeof(ImDrawVert));
+        ImVec4 bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (const ImDrawVert& v : layout->Vtx)
+        {
+            bounds.x = ImMin(bounds.x, v.pos.x);
+            bounds.y = ImMin(bounds.y, v.pos.y);
+            bounds.z = ImMax(bounds.z, v.pos.x);
+            bounds.w = ImMax(bounds.w, v.pos.y);
+        }
+        layout->Bounds = bounds;
+        layout->HasVtx = true;
+    }
+
+    // Same pixel alignment as ImFont::RenderText(), culled as a whole
+    const float x = IM_FLOOR(pos.x);
+    const float y = IM_FLOOR(pos.y);
+    const int vtx_count = layout->Vtx.Size;
+    const ImVec4& bounds = layout->Bounds;
+    if (vtx_count == 0 || x + bounds.x > clip_rect.z || x + bounds.z < clip_rect.x || y + bounds.y > clip_rect.w || y + bounds.w < clip_rect.y)
+        return true;
+
+    const int idx_count = (vtx_count / 4) * 6;
+    draw_list->PrimReserve(idx_count, vtx_count);
+    ImDrawVert* vtx_write = draw_list->_VtxWritePtr;
+    const ImDrawVert* vtx_read = layout->Vtx.Data;
+    for (int n = 0; n < vtx_count; n++)
+    {
+        vtx_write[n].pos.x = vtx_read[n].pos.x + x;
+        vtx_write[n].pos.y = vtx_read[n].pos.y + y;
+        vtx_write[n].uv = vtx_read[n].uv;
+        vtx_write[n].col = vtx_read[n].col | col;
+    }
+    ImDrawIdx* idx_write = draw_list->_IdxWritePtr;
+    unsigned int vtx_index = draw_list->_VtxCurrentIdx;
+    for (int n = 0; n < idx_count; n += 6, vtx_index += 4)
+    {
+        idx_write[n + 0] = (ImDrawIdx)(vtx_index); idx_write[n + 1] = (ImDrawIdx)(vtx_index + 1); idx_write[n + 2] = (ImDrawIdx)(vtx_index + 2);
+        idx_write[n + 3] = (ImDrawIdx)(vtx_index); idx_write[n + 4] = (ImDrawIdx)(vtx_index + 2); idx_write[n + 5] = (ImDrawIdx)(vtx_index + 3);
+    }
+    draw_list->_VtxWritePtr += vtx_count;
+    draw_list->_IdxWritePtr += idx_count;
+    draw_list->_VtxCurrentIdx = vtx_index;
+    return true;
+}
+
+#endif // #ifdef IMGUI_TEXT_LAYOUT_CACHE
+
 //-----------------------------------------------------------------------------
 // [SECTION] ImGui Internal Render Helpers
 //-----------------------------------------------------------------------------
@@ -103,6 +103,11 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 
+// ScreensaverGL: GL functions come from the app's glad loader, vertices are streamed through StreamBuffer
+#define IMGUI_IMPL_OPENGL_LOADER_CUSTOM
+#include "GLExt.h"
+#include "StreamBuffer.h"
+
 #include "imgui.h"
 #ifndef IMGUI_DISABLE
 #include "imgui_impl_opengl3.h"
@@ -204,6 +209,14 @@
 #define GL_CALL(_CALL)      _CALL   // Call without error check
 #endif
 
+// Run of consecutive commands with the same texture, drawn by one glMultiDrawElementsIndirect
+struct ImGui_ImplOpenGL3_IndirectBatch
+{
+    GLuint          Texture;
+    int             First;                   // Index of the first command in this frame's indirect region
+    int             Count;
+};
+
 // OpenGL Data
 struct ImGui_ImplOpenGL3_Data
 {
@@ -220,11 +233,28 @@ struct ImGui_ImplOpenGL3_Data
     GLuint          AttribLocationVtxPos;    // Vertex attributes location
     GLuint          AttribLocationVtxUV;
     GLuint          AttribLocationVtxColor;
-    unsigned int    VboHandle, ElementsHandle;
-    GLsizeiptr      VertexBufferSize;
-    GLsizeiptr      IndexBufferSize;
+    StreamBuffer    VertexStream;            // Persistently mapped rings, see StreamBuffer
+    StreamBuffer    IndexStream;
+    GLintptr        VertexStreamOffset;      // Where this frame's vertices and indices start
+    GLintptr        IndexStreamOffset;
     bool            HasClipOrigin;
-    bool            UseBufferSubData;
+
+    // Multi-draw-indirect path, clip rects are tested in the fragment shader
+    bool            UseMultiDrawIndirect;    // Requested by the app
+    bool            IndirectActive;          // Taken by the frame being rendered
+    GLuint          IndirectShaderHandle;
+    GLint           IndirectLocationTex;
+    GLint           IndirectLocationProjMtx;
+    GLuint          AttribLocationClipRect;
+    StreamBuffer    IndirectStream;
+    StreamBuffer    ClipStream;
+    GLintptr        IndirectStreamOffset;
+    GLintptr        ClipStreamOffset;
+    ImVector<ImGui_ImplOpenGL3_IndirectBatch> IndirectBatches;
+
+    // Last RenderDrawData()
+    int             LastCommandCount;
+    int             LastDrawCalls;
 
     ImGui_ImplOpenGL3_Data() { memset((void*)this, 0, sizeof(*this)); }
 };
@@ -308,15 +338,6 @@ bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
     bd->GlProfileIsES3 = true;
 #endif
 
-    bd->UseBufferSubData = false;
-    /*
-    // Query vendor to enable glBufferSubData kludge
-#ifdef _WIN32
-    if (const char* vendor = (const char*)glGetString(GL_VENDOR))
-        if (strncmp(vendor, "Intel", 5) == 0)
-            bd->UseBufferSubData = true;
-#endif
-    */
 #endif
 
 #ifdef IMGUI_IMPL_OPENGL_DEBUG
@@ -389,6 +410,27 @@ void    ImGui_ImplOpenGL3_NewFrame()
         ImGui_ImplOpenGL3_CreateDeviceObjects();
 }
 
+void    ImGui_ImplOpenGL3_SetMultiDrawIndirect(bool enable)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    bd->UseMultiDrawIndirect = enable;
+}
+
+bool    ImGui_ImplOpenGL3_IsMultiDrawIndirectSupported()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (!bd->ShaderHandle)
+        ImGui_ImplOpenGL3_CreateDeviceObjects();
+    return bd->IndirectShaderHandle != 0;
+}
+
+void    ImGui_ImplOpenGL3_GetLastFrameStats(int* out_commands, int* out_draw_calls)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (out_commands)   *out_commands = bd->LastCommandCount;
+    if (out_draw_calls) *out_draw_calls = bd->LastDrawCalls;
+}
+
 static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
 {
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
@@ -437,9 +479,20 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
         { 0.0f,         0.0f,        -1.0f,   0.0f },
         { (R+L)/(L-R),  (T+B)/(B-T),  0.0f,   1.0f },
     };
-    glUseProgram(bd->ShaderHandle);
-    glUniform1i(bd->AttribLocationTex, 0);
-    glUniformMatrix4fv(bd->AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+    if (bd->IndirectActive)
+    {
+        // Every draw is clipped in the fragment shader instead
+        glDisable(GL_SCISSOR_TEST);
+        glUseProgram(bd->IndirectShaderHandle);
+        glUniform1i(bd->IndirectLocationTex, 0);
+        glUniformMatrix4fv(bd->IndirectLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+    }
+    else
+    {
+        glUseProgram(bd->ShaderHandle);
+        glUniform1i(bd->AttribLocationTex, 0);
+        glUniformMatrix4fv(bd->AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+    }
 
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
     if (bd->GlVersion >= 330 || bd->GlProfileIsES3)
@@ -452,14 +505,107 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
 #endif
 
     // Bind vertex/index buffers and setup attributes for ImDrawVert
-    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->VboHandle));
-    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd->ElementsHandle));
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->VertexStream.getBuffer()));
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd->IndexStream.getBuffer()));
     GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxPos));
     GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxUV));
     GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxColor));
     GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos)));
     GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv)));
     GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col)));
+
+    // One clip rect per draw, every indirect command draws a single instance and picks its rect with baseInstance
+    if (bd->IndirectActive)
+    {
+        GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->ClipStream.getBuffer()));
+        GL_CALL(glEnableVertexAttribArray(bd->AttribLocationClipRect));
+        GL_CALL(glVertexAttribPointer(bd->AttribLocationClipRect, 4, GL_FLOAT, GL_FALSE, sizeof(ImVec4), (GLvoid*)bd->ClipStreamOffset));
+        GL_CALL(glVertexAttribDivisor(bd->AttribLocationClipRect, 1));
+        GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->VertexStream.getBuffer()));
+        GL_CALL(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, bd->IndirectStream.getBuffer()));
+    }
+}
+
+// Write one indirect command and one clip rect per command into this frame's regions, and group consecutive
+// commands with the same texture. Reordering across textures would break the blending order, so only runs merge.
+// Returns false when the frame has to take the regular path: user callbacks, nothing to draw, or no mapping.
+static bool ImGui_ImplOpenGL3_BuildIndirectBatches(ImDrawData* draw_data, int fb_height)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+
+    int cmd_total = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+            if (cmd_list->CmdBuffer[cmd_i].UserCallback != nullptr)
+                return false;
+        cmd_total += cmd_list->CmdBuffer.Size;
+    }
+    if (cmd_total == 0)
+        return false;
+
+    bd->IndirectStream.beginFrame();
+    bd->ClipStream.beginFrame();
+    DrawElementsIndirectCommand* cmd_dst = (DrawElementsIndirectCommand*)bd->IndirectStream.allocate((GLsizeiptr)cmd_total * sizeof(DrawElementsIndirectCommand), sizeof(DrawElementsIndirectCommand), bd->IndirectStreamOffset);
+    ImVec4* clip_dst = (ImVec4*)bd->ClipStream.allocate((GLsizeiptr)cmd_total * sizeof(ImVec4), sizeof(ImVec4), bd->ClipStreamOffset);
+
+    ImVec2 clip_off = draw_data->DisplayPos;
+    ImVec2 clip_scale = draw_data->FramebufferScale;
+    const GLuint idx_base = (GLuint)(bd->IndexStreamOffset / (GLintptr)sizeof(ImDrawIdx));
+    const GLint vtx_base = (GLint)(bd->VertexStreamOffset / (GLintptr)sizeof(ImDrawVert));
+
+    bd->IndirectBatches.resize(0);
+    int draw_count = 0;
+    int global_vtx_offset = 0;
+    int global_idx_offset = 0;
+    for (int n = 0; n < draw_data->CmdListsCount && cmd_dst && clip_dst; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            ImVec2 clip_min((pcmd->ClipRect.x - clip_off.x) * clip_scale.x, (pcmd->ClipRect.y - clip_off.y) * clip_scale.y);
+            ImVec2 clip_max((pcmd->ClipRect.z - clip_off.x) * clip_scale.x, (pcmd->ClipRect.w - clip_off.y) * clip_scale.y);
+            if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y || pcmd->ElemCount == 0)
+                continue;
+
+            // Same integer rect glScissor() would get, in window coordinates as seen by gl_FragCoord
+            int x = (int)clip_min.x;
+            int y = (int)((float)fb_height - clip_max.y);
+            int w = (int)(clip_max.x - clip_min.x);
+            int h = (int)(clip_max.y - clip_min.y);
+            clip_dst[draw_count] = ImVec4((float)x, (float)y, (float)(x + w), (float)(y + h));
+
+            DrawElementsIndirectCommand& cmd = cmd_dst[draw_count];
+            cmd.count = pcmd->ElemCount;
+            cmd.instanceCount = 1;
+            cmd.firstIndex = idx_base + (GLuint)global_idx_offset + pcmd->IdxOffset;
+            cmd.baseVertex = vtx_base + global_vtx_offset + (GLint)pcmd->VtxOffset;
+            cmd.baseInstance = (GLuint)draw_count;
+
+            GLuint texture = (GLuint)(intptr_t)pcmd->GetTexID();
+            if (bd->IndirectBatches.empty() || bd->IndirectBatches.back().Texture != texture)
+            {
+                ImGui_ImplOpenGL3_IndirectBatch batch = { texture, draw_count, 0 };
+                bd->IndirectBatches.push_back(batch);
+            }
+            bd->IndirectBatches.back().Count++;
+            draw_count++;
+        }
+        global_vtx_offset += cmd_list->VtxBuffer.Size;
+        global_idx_offset += cmd_list->IdxBuffer.Size;
+    }
+    bd->IndirectStream.commit();
+    bd->ClipStream.commit();
+
+    if (!cmd_dst || !clip_dst)
+    {
+        bd->IndirectStream.endFrame();
+        bd->ClipStream.endFrame();
+        return false;
+    }
+    return true;
 }
 
 // OpenGL3 Render function.
@@ -475,6 +621,40 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
 
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
 
+    // Upload every list into this frame's region of the streams, one copy per list and no buffer (re)allocation.
+    // Vertices are aligned to whole ImDrawVert so the draws can address them with a base vertex.
+    if (draw_data->TotalVtxCount == 0 || draw_data->TotalIdxCount == 0)
+        return;
+    bd->VertexStream.beginFrame();
+    bd->IndexStream.beginFrame();
+    ImDrawVert* vtx_dst = (ImDrawVert*)bd->VertexStream.allocate((GLsizeiptr)draw_data->TotalVtxCount * sizeof(ImDrawVert), sizeof(ImDrawVert), bd->VertexStreamOffset);
+    ImDrawIdx* idx_dst = (ImDrawIdx*)bd->IndexStream.allocate((GLsizeiptr)draw_data->TotalIdxCount * sizeof(ImDrawIdx), sizeof(ImDrawIdx), bd->IndexStreamOffset);
+    if (vtx_dst && idx_dst)
+    {
+        for (int n = 0; n < draw_data->CmdListsCount; n++)
+        {
+            const ImDrawList* cmd_list = draw_data->CmdLists[n];
+            memcpy(vtx_dst, cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+            memcpy(idx_dst, cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            vtx_dst += cmd_list->VtxBuffer.Size;
+            idx_dst += cmd_list->IdxBuffer.Size;
+        }
+    }
+    bd->VertexStream.commit();
+    bd->IndexStream.commit();
+    if (!vtx_dst || !idx_dst)
+    {
+        bd->VertexStream.endFrame();
+        bd->IndexStream.endFrame();
+        return;
+    }
+
+    bd->IndirectActive = bd->UseMultiDrawIndirect && bd->IndirectShaderHandle != 0 && ImGui_ImplOpenGL3_BuildIndirectBatches(draw_data, fb_height);
+    bd->LastCommandCount = 0;
+    bd->LastDrawCalls = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+        bd->LastCommandCount += draw_data->CmdLists[n]->CmdBuffer.Size;
+
     // Backup GL state
     GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
     glActiveTexture(GL_TEXTURE0);
@@ -527,41 +707,31 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
     ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
-    // Render command lists
-    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    // Render command lists, either one multi-draw per texture run or one draw per command
+    if (bd->IndirectActive)
     {
-        const ImDrawList* cmd_list = draw_data->CmdLists[n];
-
-        // Upload vertex/index buffers
-        // - OpenGL drivers are in a very sorry state nowadays....
-        //   During 2021 we attempted to switch from glBufferData() to orphaning+glBufferSubData() following reports
-        //   of leaks on Intel GPU when using multi-viewports on Windows.
-        // - After this we kept hearing of various display corruptions issues. We started disabling on non-Intel GPU, but issues still got reported on Intel.
-        // - We are now back to using exclusively glBufferData(). So bd->UseBufferSubData IS ALWAYS FALSE in this code.
-        //   We are keeping the old code path for a while in case people finding new issues may want to test the bd->UseBufferSubData path.
-        // - See https://github.com/ocornut/imgui/issues/4468 and please report any corruption issues.
-        const GLsizeiptr vtx_buffer_size = (GLsizeiptr)cmd_list->VtxBuffer.Size * (int)sizeof(ImDrawVert);
-        const GLsizeiptr idx_buffer_size = (GLsizeiptr)cmd_list->IdxBuffer.Size * (int)sizeof(ImDrawIdx);
-        if (bd->UseBufferSubData)
+        for (const ImGui_ImplOpenGL3_IndirectBatch& batch : bd->IndirectBatches)
         {
-            if (bd->VertexBufferSize < vtx_buffer_size)
-            {
-                bd->VertexBufferSize = vtx_buffer_size;
-                GL_CALL(glBufferData(GL_ARRAY_BUFFER, bd->VertexBufferSize, nullptr, GL_STREAM_DRAW));
-            }
-            if (bd->IndexBufferSize < idx_buffer_size)
-            {
-                bd->IndexBufferSize = idx_buffer_size;
-                GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, bd->IndexBufferSize, nullptr, GL_STREAM_DRAW));
-            }
-            GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0, vtx_buffer_size, (const GLvoid*)cmd_list->VtxBuffer.Data));
-            GL_CALL(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, idx_buffer_size, (const GLvoid*)cmd_list->IdxBuffer.Data));
-        }
-        else
-        {
-            GL_CALL(glBufferData(GL_ARRAY_BUFFER, vtx_buffer_size, (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW));
-            GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx_buffer_size, (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW));
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, batch.Texture));
+            GL_CALL(GLExt.MultiDrawElementsIndirect(GL_TRIANGLES, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(bd->IndirectStreamOffset + (GLintptr)batch.First * (GLintptr)sizeof(DrawElementsIndirectCommand)), batch.Count, 0));
         }
+        bd->LastDrawCalls = bd->IndirectBatches.Size;
+        bd->IndirectStream.endFrame();
+        bd->ClipStream.endFrame();
+        GL_CALL(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+    }
+
+    int global_vtx_offset = 0;
+    int global_idx_offset = 0;
+    for (int n = 0; n < draw_data->CmdListsCount && !bd->IndirectActive; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+
+        // Position of this list in the streams, filled at the top of this function
+        const GLint list_vtx_base = (GLint)(bd->VertexStreamOffset / (GLintptr)sizeof(ImDrawVert)) + global_vtx_offset;
+        const GLintptr list_idx_base = bd->IndexStreamOffset + (GLintptr)global_idx_offset * (GLintptr)sizeof(ImDrawIdx);
+        global_vtx_offset += cmd_list->VtxBuffer.Size;
+        global_idx_offset += cmd_list->IdxBuffer.Size;
 
         for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
         {
@@ -588,16 +758,17 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
 
                 // Bind texture, Draw
                 GL_CALL(glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->GetTexID()));
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
-                if (bd->GlVersion >= 320)
-                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset));
-                else
-#endif
-                GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx))));
+                // Lists share the streams, so even lists without VtxOffset need a base vertex (GL 3.2, the app asks for 3.3)
+                GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(list_idx_base + (GLintptr)pcmd->IdxOffset * (GLintptr)sizeof(ImDrawIdx)), list_vtx_base + (GLint)pcmd->VtxOffset));
+                bd->LastDrawCalls++;
             }
         }
     }
 
+    // The GPU is done with this frame's regions once everything queued so far has run
+    bd->VertexStream.endFrame();
+    bd->IndexStream.endFrame();
+
     // Destroy the temporary VAO
 #ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
     GL_CALL(glDeleteVertexArrays(1, &vertex_array_object));
@@ -850,6 +1021,36 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
         "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
         "}\n";
 
+    const GLchar* vertex_shader_indirect =
+        "uniform mat4 ProjMtx;\n"
+        "in vec2 Position;\n"
+        "in vec2 UV;\n"
+        "in vec4 Color;\n"
+        "in vec4 ClipRect;\n"
+        "out vec2 Frag_UV;\n"
+        "out vec4 Frag_Color;\n"
+        "flat out vec4 Frag_ClipRect;\n"
+        "void main()\n"
+        "{\n"
+        "    Frag_UV = UV;\n"
+        "    Frag_Color = Color;\n"
+        "    Frag_ClipRect = ClipRect;\n"
+        "    gl_Position = ProjMtx * vec4(Position.xy,0,1);\n"
+        "}\n";
+
+    const GLchar* fragment_shader_indirect =
+        "uniform sampler2D Texture;\n"
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "flat in vec4 Frag_ClipRect;\n"
+        "out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "    if (any(lessThan(gl_FragCoord.xy, Frag_ClipRect.xy)) || any(greaterThanEqual(gl_FragCoord.xy, Frag_ClipRect.zw)))\n"
+        "        discard;\n"
+        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "}\n";
+
     // Select shaders matching our GLSL versions
     const GLchar* vertex_shader = nullptr;
     const GLchar* fragment_shader = nullptr;
@@ -905,9 +1106,51 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
     bd->AttribLocationVtxUV = (GLuint)glGetAttribLocation(bd->ShaderHandle, "UV");
     bd->AttribLocationVtxColor = (GLuint)glGetAttribLocation(bd->ShaderHandle, "Color");
 
-    // Create buffers
-    glGenBuffers(1, &bd->VboHandle);
-    glGenBuffers(1, &bd->ElementsHandle);
+    // Indirect program, shares the attribute locations so the render state only differs by the clip rect
+    if (GLExt.multiDrawIndirect && glsl_version >= 130 && glsl_version != 300)
+    {
+        const GLchar* indirect_vertex_with_version[2] = { bd->GlslVersionString, vertex_shader_indirect };
+        const GLchar* indirect_fragment_with_version[2] = { bd->GlslVersionString, fragment_shader_indirect };
+        vert_handle = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vert_handle, 2, indirect_vertex_with_version, nullptr);
+        glCompileShader(vert_handle);
+        CheckShader(vert_handle, "indirect vertex shader");
+        frag_handle = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(frag_handle, 2, indirect_fragment_with_version, nullptr);
+        glCompileShader(frag_handle);
+        CheckShader(frag_handle, "indirect fragment shader");
+
+        GLuint last_location = bd->AttribLocationVtxPos > bd->AttribLocationVtxUV ? bd->AttribLocationVtxPos : bd->AttribLocationVtxUV;
+        bd->AttribLocationClipRect = (last_location > bd->AttribLocationVtxColor ? last_location : bd->AttribLocationVtxColor) + 1;
+        bd->IndirectShaderHandle = glCreateProgram();
+        glAttachShader(bd->IndirectShaderHandle, vert_handle);
+        glAttachShader(bd->IndirectShaderHandle, frag_handle);
+        glBindAttribLocation(bd->IndirectShaderHandle, bd->AttribLocationVtxPos, "Position");
+        glBindAttribLocation(bd->IndirectShaderHandle, bd->AttribLocationVtxUV, "UV");
+        glBindAttribLocation(bd->IndirectShaderHandle, bd->AttribLocationVtxColor, "Color");
+        glBindAttribLocation(bd->IndirectShaderHandle, bd->AttribLocationClipRect, "ClipRect");
+        glLinkProgram(bd->IndirectShaderHandle);
+        glDetachShader(bd->IndirectShaderHandle, vert_handle);
+        glDetachShader(bd->IndirectShaderHandle, frag_handle);
+        glDeleteShader(vert_handle);
+        glDeleteShader(frag_handle);
+        if (!CheckProgram(bd->IndirectShaderHandle, "indirect shader program"))
+        {
+            glDeleteProgram(bd->IndirectShaderHandle);
+            bd->IndirectShaderHandle = 0;
+            bd->IndirectLocationTex = -1;
+            bd->IndirectLocationProjMtx = -1;
+        }
+        else
+        {
+            bd->IndirectLocationTex = glGetUniformLocation(bd->IndirectShaderHandle, "Texture");
+            bd->IndirectLocationProjMtx = glGetUniformLocation(bd->IndirectShaderHandle, "ProjMtx");
+        }
+    }
+
+    // Create buffers, they grow to fit the largest frame
+    bd->VertexStream.create(256 * 1024);
+    bd->IndexStream.create(128 * 1024);
 
     ImGui_ImplOpenGL3_CreateFontsTexture();
 
@@ -924,8 +1167,11 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
 void    ImGui_ImplOpenGL3_DestroyDeviceObjects()
 {
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
-    if (bd->VboHandle)      { glDeleteBuffers(1, &bd->VboHandle); bd->VboHandle = 0; }
-    if (bd->ElementsHandle) { glDeleteBuffers(1, &bd->ElementsHandle); bd->ElementsHandle = 0; }
+    bd->VertexStream.destroy();
+    bd->IndexStream.destroy();
+    bd->IndirectStream.destroy();
+    bd->ClipStream.destroy();
+    if (bd->IndirectShaderHandle) { glDeleteProgram(bd->IndirectShaderHandle); bd->IndirectShaderHandle = 0; }
     if (bd->ShaderHandle)   { glDeleteProgram(bd->ShaderHandle); bd->ShaderHandle = 0; }
     ImGui_ImplOpenGL3_DestroyFontsTexture();
 }
@@ -38,6 +38,14 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// ScreensaverGL: draw runs of commands that share a texture with one glMultiDrawElementsIndirect each, clipping in the
+// fragment shader instead of with glScissor. Needs GL 4.3 or ARB_multi_draw_indirect, frames with user callbacks
+// always take the regular one draw per command path.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetMultiDrawIndirect(bool enable);
+IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_IsMultiDrawIndirectSupported();
+// Commands in the last RenderDrawData() and the GL draw calls issued for them
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_GetLastFrameStats(int* out_commands, int* out_draw_calls);
+
 // Specific OpenGL ES versions
 //#define IMGUI_IMPL_OPENGL_ES2     // Auto-detected on Emscripten
 //#define IMGUI_IMPL_OPENGL_ES3     // Auto-detected on iOS/Android
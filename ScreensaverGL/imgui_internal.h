@@ -123,6 +123,8 @@ struct ImBitVector;                 // Store 1-bit per value
 struct ImRect;                      // An axis-aligned rectangle (2 points)
 struct ImDrawDataBuilder;           // Helper to build a ImDrawData instance
 struct ImDrawListSharedData;        // Data shared between all ImDrawList instances
+struct ImTextLayout;                // Cached size and glyph quads of a piece of text
+struct ImTextLayoutCache;           // Per context cache of ImTextLayout, see IMGUI_TEXT_LAYOUT_CACHE
 struct ImGuiColorMod;               // Stacked color modifier, backup of modified data so we can restore it
 struct ImGuiContext;                // Main Dear ImGui context
 struct ImGuiContextHook;            // Hook for extensions like ImGuiTestEngine
@@ -142,6 +144,7 @@ struct ImGuiNextItemData;           // Storage for SetNextItem** functions
 struct ImGuiOldColumnData;          // Storage data for a single column for legacy Columns() api
 struct ImGuiOldColumns;             // Storage data for a columns set for legacy Columns() api
 struct ImGuiPopupData;              // Storage for current popup stack
+struct ImGuiRetainedData;           // Storage for a retained region, see BeginRetained()
 struct ImGuiSettingsHandler;        // Storage for one type registered in the .ini file
 struct ImGuiStackSizes;             // Storage of stack sizes for debugging/asserting
 struct ImGuiStyleMod;               // Stacked style modifier, backup of modified data so we can restore it
@@ -331,8 +334,22 @@ namespace ImStb
 //-----------------------------------------------------------------------------
 
 // Helpers: Hashing
+// ImHashData()/ImHashStr() use the backend picked at compile time with IMGUI_HASH_CRC32C or IMGUI_HASH_WYHASH (see imconfig.h).
+// The ImHashXXXEx() variants run any available backend, e.g. to compare them. IDs are only comparable within one backend.
+enum ImHashBackend
+{
+    ImHashBackend_Crc32,        // Table driven CRC32, one byte at a time (default)
+    ImHashBackend_Crc32c,       // Hardware CRC32C, 8 bytes at a time. Only available when compiled with SSE4.2 or ARMv8 CRC.
+    ImHashBackend_Wyhash,       // wyhash, 16 to 48 bytes at a time with 64-bit multiplies
+    ImHashBackend_COUNT
+};
 IMGUI_API ImGuiID       ImHashData(const void* data, size_t data_size, ImGuiID seed = 0);
 IMGUI_API ImGuiID       ImHashStr(const char* data, size_t data_size = 0, ImGuiID seed = 0);
+IMGUI_API ImGuiID       ImHashDataEx(ImHashBackend backend, const void* data, size_t data_size, ImGuiID seed = 0);
+IMGUI_API ImGuiID       ImHashStrEx(ImHashBackend backend, const char* data, size_t data_size = 0, ImGuiID seed = 0);
+IMGUI_API ImHashBackend ImHashBackendGetCurrent();  // The one ImHashData()/ImHashStr() use
+IMGUI_API bool          ImHashBackendIsAvailable(ImHashBackend backend);
+IMGUI_API const char*   ImHashBackendGetName(ImHashBackend backend);
 
 // Helpers: Sorting
 #ifndef ImQsort
@@ -703,6 +720,36 @@ struct ImChunkStream
 
 };
 
+// Helper: ImFrameArena
+// Linear allocator for memory that only has to stay valid until the end of the next frame (e.g. until the backend has rendered).
+// Allocations go to one of two buffers in turn and NewFrame() resets the older one, nothing is freed individually.
+// A buffer which ran out of space takes heap blocks for the rest of the frame, then grows to fit all of it when it is reset, so steady state doesn't allocate.
+#ifndef IM_FRAME_ARENA_MIN_SIZE
+#define IM_FRAME_ARENA_MIN_SIZE     (16 * 1024)
+#endif
+struct IMGUI_API ImFrameArena
+{
+    struct Buffer
+    {
+        char*           Data;
+        size_t          Capacity;
+        size_t          Used;
+        ImVector<void*> Overflow;       // Heap blocks taken once Data was full, freed on reset
+        size_t          OverflowSize;
+        Buffer()        { Data = NULL; Capacity = Used = OverflowSize = 0; }
+    };
+    Buffer              Buffers[2];
+    int                 Current;        // Buffer used by the current frame
+
+    ImFrameArena()      { Current = 0; }
+    ~ImFrameArena()     { ClearFreeMemory(); }
+    void*               Alloc(size_t size);
+    void                NewFrame();
+    void                ClearFreeMemory();
+    size_t              GetCapacity() const         { return Buffers[0].Capacity + Buffers[1].Capacity; }
+    size_t              GetLastFrameSize() const    { const Buffer& buf = Buffers[Current ^ 1]; return buf.Used + buf.OverflowSize; }
+};
+
 // Helper: ImGuiTextIndex<>
 // Maintain a line index for a text buffer. This is a strong candidate to be moved into the public API.
 struct ImGuiTextIndex
@@ -766,11 +813,74 @@ struct IMGUI_API ImDrawListSharedData
     float           ArcFastRadiusCutoff;                        // Cutoff radius after which arc drawing will fallback to slower PathArcTo()
     ImU8            CircleSegmentCounts[64];    // Precomputed segment count for given radius before we calculate it dynamically (to avoid calculation overhead)
     const ImVec4*   TexUvLines;                 // UV of anti-aliased lines in the atlas
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+    ImTextLayoutCache* TextLayoutCache;         // Used by AddText() when set, the context sets it to its own cache in NewFrame()
+#endif
 
     ImDrawListSharedData();
     void SetCircleTessellationMaxError(float max_error);
 };
 
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+
+// Text layout cache: limits
+#ifndef IM_TEXT_LAYOUT_CACHE_MAX_LENGTH
+#define IM_TEXT_LAYOUT_CACHE_MAX_LENGTH                         256 // Longer text is always measured and rendered from scratch.
+#endif
+#ifndef IM_TEXT_LAYOUT_CACHE_MAX_AGE
+#define IM_TEXT_LAYOUT_CACHE_MAX_AGE                            120 // Evict layouts not used for that many frames.
+#endif
+
+// Size and glyph quads of a piece of text for a given font, font size and wrap width. The text itself is stored right after the structure.
+// Quads are relative to the floored render position, col is 0 for tinted glyphs and ~IM_COL32_A_MASK for colored glyphs so OR-ing the text color in gives the same colors as ImFont::RenderText().
+struct ImTextLayout
+{
+    ImGuiID                 Key;
+    const ImFont*           Font;
+    float                   FontSize;
+    float                   WrapWidth;
+    int                     TextLen;
+    bool                    InFrameArena;       // Seen a single time so far, moved to the heap when seen in a later frame
+    int                     CreatedGeneration;
+    int                     LastUsedGeneration;
+    bool                    HasSize;
+    bool                    HasVtx;
+    ImVec2                  Size;               // ImFont::CalcTextSizeA() with no max width, valid with HasSize
+    ImVec4                  Bounds;             // Bounding box of Vtx, valid with HasVtx
+    ImVector<ImDrawVert>    Vtx;                // 4 vertices per glyph, valid with HasVtx
+
+    const char*             GetText() const     { return (const char*)(this + 1); }
+};
+
+// Per context cache of text layouts keyed by (font, font size, text hash, wrap width), for labels submitted every frame.
+// Quads are only built the second frame a text is seen, so text that changes every frame (e.g. a counter) never pays for them.
+// The shared draw list data points to it, so like the rest of the context it is not thread-safe.
+struct ImTextLayoutCache
+{
+    ImVector<ImTextLayout*> Layouts;
+    ImGuiStorage            Map;                // Key -> index in Layouts
+    ImTextLayout*           LastLayout;         // Widgets measure then render the same text, check it before hashing
+    ImFrameArena*           FrameArena;         // Layouts seen for the first time are allocated there when set, most text seen once never reaches the heap
+    int                     Generation;         // Incremented by NewFrame()
+    ImDrawList*             ScratchDrawList;    // Used to build quads with ImFont::RenderText()
+    ImVec2                  TexUvWhitePixel;    // Atlas the quads were built from, clear everything when it changes
+    ImTextureID             TexID;
+    int                     Hits, Misses;       // Current frame
+    int                     HitsLastFrame, MissesLastFrame;
+
+    ImTextLayoutCache()     { LastLayout = NULL; FrameArena = NULL; Generation = 0; ScratchDrawList = NULL; TexID = (ImTextureID)NULL; Hits = Misses = HitsLastFrame = MissesLastFrame = 0; }
+    ~ImTextLayoutCache()    { Clear(); }
+
+    IMGUI_API void          Clear();
+    IMGUI_API void          NewFrame(ImFontAtlas* atlas);     // Evict layouts not used for IM_TEXT_LAYOUT_CACHE_MAX_AGE frames
+    IMGUI_API ImTextLayout* PromoteLayout(ImTextLayout* layout);                // Move a layout from the frame arena to the heap
+    IMGUI_API ImTextLayout* GetLayout(const ImFont* font, float font_size, float wrap_width, const char* text_begin, const char* text_end); // NULL when the text cannot be cached
+    IMGUI_API ImVec2        CalcTextSize(const ImFont* font, float font_size, float wrap_width, const char* text_begin, const char* text_end);
+    IMGUI_API bool          AddText(ImDrawList* draw_list, const ImFont* font, float font_size, const ImVec2& pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, float wrap_width); // false when the caller has to render the text itself
+};
+
+#endif // #ifdef IMGUI_TEXT_LAYOUT_CACHE
+
 struct ImDrawDataBuilder
 {
     ImVector<ImDrawList*>*  Layers[2];      // Pointers to global layers for: regular, tooltip. LayersP[0] is owned by DrawData.
@@ -1133,6 +1243,48 @@ struct ImGuiPopupData
     ImGuiPopupData()    { memset(this, 0, sizeof(*this)); ParentNavLayer = OpenFrameCount = -1; }
 };
 
+// Storage for a retained region (BeginRetained()/EndRetained())
+// Contents are drawn in their own channel, the channel's commands/indices and the vertices are recorded along with the layout they ended with.
+struct ImGuiRetainedData
+{
+    ImGuiID                 ID;
+    ImGuiID                 Hash;               // State hash given to BeginRetained() combined with the window state the contents depend on
+    ImGuiWindow*            Window;
+    float                   LastTimeActive;     // For garbage collection, -1.0f when compacted
+    bool                    Valid;              // Recorded contents below can be replayed
+    bool                    Discard;            // Set while recording when the contents are not kept: they may be interacted with, or the state hash just changed
+    ImDrawListSplitter      Splitter;
+    ImVector<ImDrawCmd>     CmdBuffer;          // Recorded channel, IdxOffset are relative to IdxBuffer
+    ImVector<ImDrawIdx>     IdxBuffer;
+    ImVector<ImDrawVert>    VtxBuffer;
+    unsigned int            VtxStartIdx;        // ImDrawList::_VtxCurrentIdx when recording started, indices are rebased from it
+    ImRect                  Rect;               // Extents of the contents, for hovering checks
+
+    // Layout at the end of the contents (CursorMaxPos/IdealMaxPos only cover the contents)
+    ImVec2                  CursorPos;
+    ImVec2                  CursorPosPrevLine;
+    ImVec2                  CursorMaxPos;
+    ImVec2                  IdealMaxPos;
+    ImVec2                  CurrLineSize;
+    ImVec2                  PrevLineSize;
+    float                   CurrLineTextBaseOffset;
+    float                   PrevLineTextBaseOffset;
+    bool                    IsSameLine;
+    bool                    IsSetPos;
+    short                   NavLayersActiveMaskNext;
+
+    // Backup while recording
+    ImVec2                  BackupCursorMaxPos;
+    ImVec2                  BackupIdealMaxPos;
+    short                   BackupNavLayersActiveMaskNext;
+    int                     BackupVtxBufferSize;
+    unsigned int            BackupVtxOffset;
+    int                     BackupChildWindowsCount;
+
+    ImGuiRetainedData()     { ID = Hash = 0; Window = NULL; LastTimeActive = -1.0f; Valid = Discard = false; VtxStartIdx = 0; }
+    void                    ClearFreeMemory() { Valid = false; Splitter.ClearFreeMemory(); CmdBuffer.clear(); IdxBuffer.clear(); VtxBuffer.clear(); }
+};
+
 enum ImGuiNextWindowDataFlags_
 {
     ImGuiNextWindowDataFlags_None               = 0,
@@ -1783,6 +1935,12 @@ struct ImGuiContext
     float                   FontSize;                           // (Shortcut) == FontBaseSize * g.CurrentWindow->FontWindowScale == window->FontSize(). Text height for current window.
     float                   FontBaseSize;                       // (Shortcut) == IO.FontGlobalScale * Font->Scale * Font->FontSize. Base text height.
     ImDrawListSharedData    DrawListSharedData;
+    ImFrameArena            FrameArena;                         // For ImGui::MemAllocFrame()
+    int                     FrameAllocCount;                    // MemAlloc()/MemFree() calls since the last NewFrame()
+    int                     FrameFreeCount;
+#ifdef IMGUI_TEXT_LAYOUT_CACHE
+    ImTextLayoutCache       TextLayoutCache;
+#endif
     double                  Time;
     int                     FrameCount;
     int                     FrameCountEnded;
@@ -1973,6 +2131,14 @@ struct ImGuiContext
     ImVector<float>                 TablesLastTimeActive;       // Last used timestamp of each tables (SOA, for efficient GC)
     ImVector<ImDrawChannel>         DrawChannelsTempMergeBuffer;
 
+    // Retained regions
+    ImGuiRetainedData*              CurrentRetained;            // Region being recorded, between BeginRetained() and EndRetained()
+    ImPool<ImGuiRetainedData>       Retained;
+    int                             RetainedReplayedCount;      // Regions replayed/recorded this frame
+    int                             RetainedRecordedCount;
+    int                             RetainedReplayedCountLastFrame;
+    int                             RetainedRecordedCountLastFrame;
+
     // Tab bars
     ImGuiTabBar*                    CurrentTabBar;
     ImPool<ImGuiTabBar>             TabBars;
@@ -2185,6 +2351,9 @@ struct ImGuiContext
         ClipperTempDataStacked = 0;
 
         CurrentTable = NULL;
+        CurrentRetained = NULL;
+        FrameAllocCount = FrameFreeCount = 0;
+        RetainedReplayedCount = RetainedRecordedCount = RetainedReplayedCountLastFrame = RetainedRecordedCountLastFrame = 0;
         TablesTempDataStacked = 0;
         CurrentTabBar = NULL;
 
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <thread>
 #include <fstream>
 #include <sstream>
@@ -20,277 +22,99 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "Context.h"
+#include "Shader.h"
+#include "BoxSwarm.h"
+#include "GLExt.h"
+#include "TextureAtlas.h"
+#include "TextureLoader.h"
+#include "TextureManager.h"
+#include "RenderTarget.h"
+#include "Profiler.h"
+#include "Timestep.h"
+#include "Hash.h"
+#include "VideoCapture.h"
+#include "AllocTracker.h"
+
+#ifdef _WIN32
 #include <Windows.h>
 #include <ShObjIdl.h>
+#endif
 
 #define GLSL_VERSION	"#version 330 core"
 
-typedef std::string String;
+// Simulated frames per second in headless mode, so runs are reproducible
+#define HEADLESS_FRAME_RATE	60
 
-void frameBufferCallback(GLFWwindow *window, int width, int height);
-
-struct Shader
-{
-private:
-	static constexpr int VERT_LENGTH = 20;
-
-	float verts[VERT_LENGTH];
-	int indices[6] = {
-		0, 2, 3,
-		0, 1, 2
-	};
-
-	// Buffers
-	GLuint VAO, VBO, EBO;
-
-	// Box properties
-	GLuint programId;
-
-	// Texture properties
-	GLuint texture = 0;
-	int txWidth, txHeight, txChannels;
-
-public:
-	ImVec4 color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
-
-	void create(float size, ImVec4 color)
-	{
-		this->color = color;
-
-		float newVerts[VERT_LENGTH] = {
-			// Pos				// Texture coordinate
-			-size,  size, 0.0f,	0.0f, 1.0f,
-			 size,  size, 0.0f,	1.0f, 1.0f,
-			 size, -size, 0.0f,	1.0f, 0.0f,
-			-size, -size, 0.0f,	0.0f, 0.0f
-		};
-
-		for (int i = 0; i < VERT_LENGTH; i++)
-			verts[i] = newVerts[i];
-
-		glGenBuffers(1, &VBO);
-		glGenVertexArrays(1, &VAO);
-		glGenBuffers(1, &EBO);
-	}
-
-	void createShader(const char *vertFile, const char *fragFile)
-	{
-		String vertCode, fragCode;
-		std::ifstream vertShaderFile, fragShaderFile;
-
-		vertShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		fragShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-		try
-		{
-			vertShaderFile.open(vertFile);
-			fragShaderFile.open(fragFile);
-
-			std::stringstream vertShaderStream, fragShaderStream;
-
-			vertShaderStream << vertShaderFile.rdbuf();
-			fragShaderStream << fragShaderFile.rdbuf();
-
-			vertShaderFile.close();
-			fragShaderFile.close();
-
-			vertCode = vertShaderStream.str();
-			fragCode = fragShaderStream.str();
-		}
-		catch (const std::ifstream::failure e)
-		{
-			printf("%s\n", e.what());
-			return;
-		}
-
-		const char *vertexShader = vertCode.c_str();
-		const char *fragShader = fragCode.c_str();
-
-		GLuint vertex, fragment;
-		int success;
-		char infoLog[512];
-
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vertexShader, NULL);
-		glCompileShader(vertex);
-
-		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-			printf("%s\n", infoLog);
-			return;
-		}
-
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fragShader, NULL);
-		glCompileShader(fragment);
-
-		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-			printf("%s\n", infoLog);
-			return;
-		}
-
-		this->programId = glCreateProgram();
-		glAttachShader(this->programId, vertex);
-		glAttachShader(this->programId, fragment);
-		glLinkProgram(this->programId);
-
-		glGetProgramiv(this->programId, GL_LINK_STATUS, &success);
-		if (!success)
-		{
-			glGetProgramInfoLog(this->programId, 512, NULL, infoLog);
-			printf("Program link failed\n%s\n", infoLog);
-			return;
-		}
-
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
-	}
-
-	void createBufferData()
-	{
-		glBindVertexArray(VAO);
-
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(this->verts), this->verts, GL_DYNAMIC_DRAW);
-
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(this->indices), this->indices, GL_DYNAMIC_DRAW);
-
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (GLvoid *)0);
-		glEnableVertexAttribArray(0);
+// Arrow key speed, in normalized device coordinates per second
+#define BOX_SPEED			0.25f
 
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (GLvoid *)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
-	}
-
-	void createTexture(const char *txFile, GLint wrapS, GLint wrapT, GLint filterMin, GLint filterMag, GLenum fmt = GL_RGB)
-	{
-		glGenTextures(1, &this->texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filterMin);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMag);
-
-		stbi_set_flip_vertically_on_load(true);
-
-		unsigned char *data = stbi_load(txFile, &this->txWidth, &this->txHeight, &this->txChannels, 0);
-		if (!data)
-		{
-			printf("Failed to load texture file\nFile: %s\n", txFile);
-			return;
-		}
-
-		glTexImage2D(GL_TEXTURE_2D, 0, fmt, this->txWidth, this->txHeight, 0, fmt, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		stbi_image_free(data);
-	}
+// Longest sleep between idle frames, so ImGui timers like tooltips and the text cursor still run
+#define IDLE_WAIT_TIMEOUT	0.1
 
-	void deleteTexture()
-	{
-		glDeleteTextures(1, &texture);
+// Frames reported in full by --alloc-check, the rest are only counted
+#define ALLOC_CHECK_REPORTS	5
 
-		glUniform1i(glGetUniformLocation(this->programId, "uUseTexture"), false);
+void frameBufferCallback(GLFWwindow *window, int width, int height);
+void windowRefreshCallback(GLFWwindow *window);
 
-		texture = NULL;
-	}
+struct
+{
+	ImVec4 backgroundColor = ImVec4(0.0f, 0.0f, 0.0f, 1.0f);
 
-	void use()
-	{
-		glUseProgram(this->programId);
-	}
+	int width = 1280, height = 720;
+	const char *title = "ScreenSaver GL";
 
-	void draw()
-	{
-		this->use();
+	bool showDemoWindow			= false;
+	bool showAppOptions			= false;
+	bool showBoxConfig			= false;
+	bool showProfiler			= false;
+	bool showTextureModalChange	= false;
+	bool showTextureModalDelete = false;
 
-		if (hasTexture())
-		{
-			glUniform1i(glGetUniformLocation(this->programId, "uUseTexture"), true);
+	// Render offscreen without vsync for a fixed number of frames, then exit
+	bool headless = false;
+	int headlessFrames = 600;
 
-			glBindTexture(GL_TEXTURE_2D, this->texture);
-		}
+	// Write every frame to a video, "-" for stdout. The simulation runs at the capture rate while it is on.
+	const char *capturePath = NULL;
+	int captureFps = 60;
+	VideoFormat captureFormat = VideoFormat_Y4M;
+	bool captureFormatGiven = false;
 
-		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, sizeof(this->indices) / sizeof(int), GL_UNSIGNED_INT, 0);
+	// Fail the run if the heap is used after this frame, -1 when off. Meant for headless runs, which always play the same scene.
+	int allocCheckFrame = -1;
+	int allocCheckFailures = 0;
 
-		glUniform4f(glGetUniformLocation(getProgramID(), "uColor"), color.x, color.y, color.z, color.w);
-	}
+	bool showBox = true;
+	bool boxMoving = true;
 
-	GLuint getVAO(GLuint id)
-	{
-		return this->VAO;
-	}
+	// Keep the last frame on screen and wait for events while nothing changes
+	bool skipIdleFrames = false;
+	bool forceRedraw = true;
+	unsigned skippedFrames = 0;
 
-	GLuint getVBO(GLuint id)
-	{
-		return this->VBO;
-	}
+	// Count on screen, only updated on drawn frames since a change would make the next frame differ and be drawn
+	unsigned shownSkippedFrames = 0;
 
-	GLuint getEBO(GLuint id)
-	{
-		return this->EBO;
-	}
+	int swarmCount = 0;
+	float swarmBoxSize = 0.05f;
+	bool swarmCollisions = false;
 
-	GLuint getProgramID()
-	{
-		return this->programId;
-	}
+	// Draw the UI with multi-draw indirect where the driver has it
+	bool uiMultiDraw = false;
 
-	GLuint getTexture()
-	{
-		return this->texture;
-	}
+	// Simulation steps per second, independent of the display rate
+	float simRate = 120.0f;
 
-	int getTextureWidth()
-	{
-		return this->txWidth;
-	}
+	// Id of the texture being loaded for the box, 0 when idle
+	int pendingTexture = 0;
 
-	int getTextureHeight()
-	{
-		return this->txHeight;
-	}
+	// Id of the logo being loaded for the swarm atlas, 0 when idle
+	int pendingLogo = 0;
 
-	bool hasTexture()
-	{
-		return (texture != 0) ? true : false;
-	}
-};
-
-struct Box : public Shader
-{
-	glm::mat4 model = glm::mat4(1.0f);
-
-	glm::vec3 pos = glm::vec3(0.0f);
-
-	Box(const char *vf, const char *ff, float size, ImVec4 color)
-	{
-		create(size, color);
-		createShader(vf, ff);
-		createBufferData();
-	}
-};
-
-struct
-{
-	ImVec4 backgroundColor = ImVec4(0.0f, 0.0f, 0.0f, 1.0f);
-
-	int width = 1280, height = 720;
-	const char *title = "ScreenSaver GL";
-
-	bool showDemoWindow			= false;
-	bool showAppOptions			= false;
-	bool showBoxConfig			= false;
-	bool showTextureModalChange	= false;
-	bool showTextureModalDelete = false;
+	// Whether the file picked in the dialog goes to the swarm atlas instead of the box
+	bool textureForSwarm = false;
 
 	String filePath;
 
@@ -333,8 +157,119 @@ struct
 		}
 	}
 
+	// Returns false on bad arguments
+	bool parseArgs(int argc, char **argv)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const char *arg = argv[i];
+			const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+			if (strcmp(arg, "--headless") == 0)
+			{
+				headless = true;
+			}
+			else if (strcmp(arg, "--skip-idle") == 0)
+			{
+				skipIdleFrames = true;
+			}
+			else if (strcmp(arg, "--frames") == 0 && value)
+			{
+				headlessFrames = atoi(value);
+				i++;
+			}
+			else if (strcmp(arg, "--swarm") == 0 && value)
+			{
+				swarmCount = atoi(value);
+				i++;
+			}
+			else if (strcmp(arg, "--capture") == 0 && value)
+			{
+				capturePath = value;
+				i++;
+			}
+			else if (strcmp(arg, "--fps") == 0 && value)
+			{
+				captureFps = atoi(value);
+				i++;
+			}
+			else if (strcmp(arg, "--format") == 0 && value)
+			{
+				if (strcmp(value, "y4m") == 0)
+					captureFormat = VideoFormat_Y4M;
+				else if (strcmp(value, "rgba") == 0)
+					captureFormat = VideoFormat_RGBA;
+				else
+				{
+					printf("Unknown video format: %s\n", value);
+					return false;
+				}
+
+				captureFormatGiven = true;
+				i++;
+			}
+			else if (strcmp(arg, "--alloc-check") == 0 && value)
+			{
+				allocCheckFrame = atoi(value);
+				if (allocCheckFrame < 0)
+				{
+					printf("Invalid --alloc-check value\n");
+					return false;
+				}
+
+				i++;
+			}
+			else if (strcmp(arg, "--size") == 0 && value)
+			{
+				char *end;
+				width = (int)strtol(value, &end, 10);
+				height = (*end == 'x') ? (int)strtol(end + 1, NULL, 10) : 0;
+				i++;
+			}
+			else
+			{
+				printf("Unknown argument: %s\n", arg);
+				return false;
+			}
+		}
+
+		if (width <= 0 || height <= 0 || headlessFrames <= 0 || swarmCount < 0 || captureFps <= 0)
+		{
+			printf("Invalid --size, --frames, --swarm or --fps value\n");
+			return false;
+		}
+
+		if (capturePath && !captureFormatGiven)
+			captureFormat = getVideoFormatForPath(capturePath);
+
+		return true;
+	}
+
+	// Called with the number of the frame that just ended, reports its allocations once past allocCheckFrame
+	void checkAllocs(int frame)
+	{
+		if (allocCheckFrame < 0)
+			return;
+
+		// Recording call sites is slow, only do it for the frames being checked
+		if (frame == allocCheckFrame)
+			Allocs.setRecordSites(true);
+
+		if (frame <= allocCheckFrame || Allocs.lastFrame.allocs == 0)
+			return;
+
+		allocCheckFailures++;
+
+		if (allocCheckFailures <= ALLOC_CHECK_REPORTS)
+		{
+			fprintf(stderr, "Frame %d used the heap: ", frame);
+			Allocs.printLastFrame(stderr);
+		}
+	}
+
 	void showOpenFileDialog(String *out)
 	{
+#ifdef _WIN32
 		std::mutex mutex;
 
 		HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
@@ -383,6 +318,9 @@ struct
 
 			CoUninitialize();
 		}
+#else
+		printf("File dialog is only available on Windows\n");
+#endif
 	}
 } App;
 
@@ -391,6 +329,64 @@ void frameBufferCallback(GLFWwindow *window, int width, int height)
 	glViewport(0, 0, width, height);
 }
 
+// The window system lost what was on screen, the next frame is drawn even if nothing changed
+void windowRefreshCallback(GLFWwindow *window)
+{
+	App.forceRedraw = true;
+}
+
+// Everything the UI is about to draw, vertices and the state of every command
+static uint64_t hashDrawData(const ImDrawData *drawData, uint64_t hash)
+{
+	hash = hashBytes(&drawData->DisplaySize, sizeof(drawData->DisplaySize), hash);
+	hash = hashBytes(&drawData->FramebufferScale, sizeof(drawData->FramebufferScale), hash);
+
+	for (int i = 0; i < drawData->CmdListsCount; i++)
+	{
+		const ImDrawList *list = drawData->CmdLists[i];
+
+		hash = hashBytes(list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes(), hash);
+		hash = hashBytes(list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes(), hash);
+
+		for (const ImDrawCmd &cmd : list->CmdBuffer)
+		{
+			ImTextureID texture = cmd.GetTexID();
+
+			hash = hashBytes(&cmd.ClipRect, sizeof(cmd.ClipRect), hash);
+			hash = hashBytes(&texture, sizeof(texture), hash);
+			hash = hashBytes(&cmd.ElemCount, sizeof(cmd.ElemCount), hash);
+			hash = hashBytes(&cmd.IdxOffset, sizeof(cmd.IdxOffset), hash);
+			hash = hashBytes(&cmd.VtxOffset, sizeof(cmd.VtxOffset), hash);
+		}
+	}
+
+	return hash;
+}
+
+struct FontAtlasTasks
+{
+	void (*func)(void *data, int begin, int end);
+	void *data;
+};
+
+static void runFontAtlasTasks(void *data, size_t begin, size_t end)
+{
+	FontAtlasTasks *tasks = (FontAtlasTasks *)data;
+	tasks->func(tasks->data, (int)begin, (int)end);
+}
+
+// Rasterizes the font atlas glyphs on the job system, the atlas is built on the main thread which waits here
+static void fontAtlasParallelFor(int count, void (*func)(void *data, int begin, int end), void *data, void *userData)
+{
+	JobSystem *jobs = (JobSystem *)userData;
+
+	FontAtlasTasks tasks = { func, data };
+	JobFence fence;
+
+	jobs->parallelFor((size_t)count, 1, runFontAtlasTasks, &tasks, fence);
+	fence.wait();
+}
+
 void changeTexture_concurrent()
 {
 	App.showOpenFileDialog(&App.filePath);
@@ -399,75 +395,200 @@ void changeTexture_concurrent()
 		App.showTextureModalChange = true;
 }
 
-int main()
-{
-	// OpenGL init
-	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, GLFW_VERSION_MAJOR);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, GLFW_VERSION_MINOR);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+void runScene(GLFWwindow *window, RenderTarget &target);
 
-	GLFWwindow *window = glfwCreateWindow(App.width, App.height, App.title, NULL, NULL);
-	if (!window)
+int main(int argc, char **argv)
+{
+	if (!App.parseArgs(argc, argv))
 	{
-		printf("Cannot create Window for GLFW!\n");
+		printf("Usage: %s [--headless] [--frames N] [--swarm N] [--size WxH] [--skip-idle] [--capture FILE|-] [--fps N] [--format y4m|rgba] [--alloc-check N]\n", argv[0]);
 		return -1;
 	}
 
-	glfwMakeContextCurrent(window);
-	glfwSwapInterval(1);
+	// OpenGL init
+	GLFWwindow *window = createContextWindow(App.width, App.height, App.title, App.headless);
+	if (!window)
+		return -1;
 
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	// Headless frames are only limited by how fast they render
+	if (!initContext(window, !App.headless))
 	{
-		printf("Failed to initialize GLAD\n");
+		glfwDestroyWindow(window);
+		glfwTerminate();
 		return -1;
 	}
 
 	glViewport(0, 0, App.width, App.height);
 	glfwSetFramebufferSizeCallback(window, frameBufferCallback);
+	glfwSetWindowRefreshCallback(window, windowRefreshCallback);
 
 	IMGUI_CHECKVERSION();
+	installImGuiAllocator();
 	ImGui::CreateContext();
 	ImGuiIO &io = ImGui::GetIO(); (void)io;
 
 	ImGui::StyleColorsDark();
 
+	// Keep benchmark runs independent of whatever layout was saved last
+	if (App.headless)
+		io.IniFilename = NULL;
+
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
 	ImGui_ImplOpenGL3_Init(GLSL_VERSION);
 
+	// Without its target a headless run still goes through the teardown below
+	RenderTarget target;
+	bool targetReady = !App.headless || target.create(App.width, App.height);
+
+	if (targetReady)
+		runScene(window, target);
+
+	target.destroy();
+	Profile.shutdown();
+	Programs.clear();
+
+	ImGui_ImplOpenGL3_Shutdown();
+	ImGui_ImplGlfw_Shutdown();
+	ImGui::DestroyContext();
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	if (!targetReady)
+		return -1;
+
+	return (App.allocCheckFailures > 0) ? 1 : 0;
+}
+
+// Everything holding GL objects lives in here, so it is gone before the context is destroyed
+void runScene(GLFWwindow *window, RenderTarget &target)
+{
 	// Create box
 	Box box("T1_Shader.vert", "T1_Shader.frag", 0.2f, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
 
-	float lastTime = 0;
+	BounceSim boxSim;
+	boxSim.resize(1);
+	boxSim.velX[0] = 0.125f;
+	boxSim.velY[0] = 0.125f;
+
+	JobSystem jobs;
+
+	TextureLoader textureLoader(jobs);
+	TextureManager textureManager(textureLoader, jobs);
+
+	// The atlas is built on the first frame
+	ImFontAtlas *fonts = ImGui::GetIO().Fonts;
+	fonts->ParallelFor = fontAtlasParallelFor;
+	fonts->ParallelForUserData = &jobs;
+
+	VideoCapture capture(jobs);
+	if (App.capturePath)
+	{
+		int captureWidth = App.width, captureHeight = App.height;
+		if (!App.headless)
+			glfwGetFramebufferSize(window, &captureWidth, &captureHeight);
+
+		if (!capture.open(App.capturePath, App.captureFormat, captureWidth, captureHeight, App.captureFps))
+			return;
+	}
+
+	// Create swarm, all of its boxes are drawn with one instanced draw call
+	BoxSwarm swarm("T1_Shader_Instanced.vert", "T1_Shader_Instanced.frag", App.swarmBoxSize);
+	TextureAtlas logoAtlas;
+
+	if (App.swarmCount > 0)
+		swarm.resize(App.swarmCount);
+
+	FixedTimestep simClock(glfwGetTimerFrequency(), App.simRate);
+
+	int frame = 0;
+	double startTime = glfwGetTime();
+
+	uint64_t lastFrameHash = 0;
+	bool frameSkipped = false;
+
 	while (!glfwWindowShouldClose(window))
 	{
-		float currTime = (float)glfwGetTime();
+		// Heap use of the frame before, from every thread
+		Allocs.endFrame();
+		App.checkAllocs(frame);
 
-		float deltaTime = currTime - lastTime;
+		if (App.headless && frame == App.headlessFrames)
+			break;
 
-		lastTime = currTime;
+		frame++;
 
-		float boxSpeed = 0.25f * deltaTime;
+		// GL stats on screen stay those of the last drawn frame, skipped frames make no draw calls
+		if (!frameSkipped)
+			GLState.beginFrame();
+
+		Profile.beginFrame();
+
+		// Fixed steps due this frame, a headless or captured frame always covers the same amount of time
+		int steps;
+		if (capture.isOpen())
+			steps = simClock.advanceBy(simClock.getFrequency() / capture.getFps());
+		else if (App.headless)
+			steps = simClock.advanceBy(simClock.getFrequency() / HEADLESS_FRAME_RATE);
+		else
+			steps = simClock.advance(glfwGetTimerValue());
+
+		if (App.headless)
+			target.bind();
+
+		float stepTime = simClock.getStepTime();
+		float alpha = simClock.getAlpha();
+
+		Profile.pushZone("Input");
+
+		glm::vec3 boxInput(0.0f);
 
 		if (GLFW_PRESS == glfwGetKey(window, GLFW_KEY_UP))
-			box.pos += glm::vec3(0.0f, 1.0f, 0.0f) * boxSpeed;
+			boxInput += glm::vec3(0.0f, 1.0f, 0.0f);
 
 		if (GLFW_PRESS == glfwGetKey(window, GLFW_KEY_DOWN))
-			box.pos += glm::vec3(0.0f, -1.0f, 0.0f) * boxSpeed;
+			boxInput += glm::vec3(0.0f, -1.0f, 0.0f);
 
 		if (GLFW_PRESS == glfwGetKey(window, GLFW_KEY_LEFT))
-			box.pos += glm::vec3(-1.0f, 0.0f, 0.0f) * boxSpeed;
+			boxInput += glm::vec3(-1.0f, 0.0f, 0.0f);
 
 		if (GLFW_PRESS == glfwGetKey(window, GLFW_KEY_RIGHT))
-			box.pos += glm::vec3(1.0f, 0.0f, 0.0f) * boxSpeed;
+			boxInput += glm::vec3(1.0f, 0.0f, 0.0f);
 
-		glClearColor(
-			App.backgroundColor.x,
-			App.backgroundColor.y,
-			App.backgroundColor.z,
-			App.backgroundColor.w
-		);
-		glClear(GL_COLOR_BUFFER_BIT);
+		Profile.popZone();
+
+		// Step the swarm on the worker threads while the UI is being built
+		Profile.pushZone("Simulation");
+		swarm.update(steps, stepTime, alpha, jobs);
+
+		for (int i = 0; i < steps; i++)
+		{
+			if (i == steps - 1)
+				boxSim.savePrevious(0, 1);
+
+			boxSim.posX[0] += boxInput.x * BOX_SPEED * stepTime;
+			boxSim.posY[0] += boxInput.y * BOX_SPEED * stepTime;
+
+			if (App.boxMoving)
+				boxSim.step(stepTime);
+
+			// Reset the box if it goes outside the frame
+			if (
+				boxSim.posX[0] >  1.0f ||
+				boxSim.posX[0] < -1.0f ||
+				boxSim.posY[0] >  1.0f ||
+				boxSim.posY[0] < -1.0f
+			) {
+				boxSim.teleport(0, 0.0f, 0.0f);
+			}
+		}
+
+		box.pos.x = boxSim.getX(0, alpha);
+		box.pos.y = boxSim.getY(0, alpha);
+
+		Profile.popZone();
+
+		Profile.pushZone("ImGui build");
 
 		ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplGlfw_NewFrame();
@@ -481,8 +602,9 @@ int main()
 
 				ImGui::Separator();
 
+				// Finish the frame so every zone and ImGui scope is closed, the loop ends after it
 				if (ImGui::MenuItem("Exit"))
-					break;
+					glfwSetWindowShouldClose(window, GLFW_TRUE);
 
 				ImGui::EndMenu();
 			}
@@ -490,6 +612,7 @@ int main()
 			if (ImGui::BeginMenu("Tools"))
 			{
 				ImGui::MenuItem("Config", NULL, &App.showBoxConfig);
+				ImGui::MenuItem("Profiler", NULL, &App.showProfiler);
 
 				ImGui::EndMenu();
 			}
@@ -508,13 +631,137 @@ int main()
 		if (App.showDemoWindow)
 			ImGui::ShowDemoWindow(&App.showDemoWindow);
 
+		if (App.showProfiler)
+			Profile.drawWindow(&App.showProfiler);
+
 		if (App.showAppOptions)
 		{
 			ImGui::Begin("Settings", &App.showAppOptions);
 
-			ImGui::SeparatorText("Window");
+			// The color picker is the most expensive part of the UI to build and rarely changes, reuse it while its state is the same
+			uint64_t windowSectionHash = hashBytes(&App.backgroundColor, sizeof(App.backgroundColor));
+			windowSectionHash = hashBytes(&App.skipIdleFrames, sizeof(App.skipIdleFrames), windowSectionHash);
+
+			if (ImGui::BeginRetained("Window", (ImGuiID)windowSectionHash))
+			{
+				ImGui::SeparatorText("Window");
+
+				ImGui::ColorPicker4("Background Color", (float *)&App.backgroundColor);
+
+				ImGui::Checkbox("Skip idle frames", &App.skipIdleFrames);
+				ImGui::SetItemTooltip("Keep the last frame and wait for input while nothing on screen changes, saves power");
+
+				ImGui::EndRetained();
+			}
+
+			if (App.skipIdleFrames)
+				ImGui::Text("Skipped frames: %u", App.shownSkippedFrames);
+
+			ImGui::SeparatorText("Capture");
+
+			if (capture.isOpen())
+			{
+				if (ImGui::Button("Stop capture"))
+					capture.close();
+
+				ImGui::Text("Frames: %u | Stalls: %u", capture.framesWritten, capture.stalls);
+				ImGui::SetItemTooltip("Stalls are frames that waited for a readback, the ring of pixel buffers was full");
+			}
+			else
+			{
+				if (ImGui::Button("Capture to capture.y4m"))
+				{
+					int captureWidth, captureHeight;
+					glfwGetFramebufferSize(window, &captureWidth, &captureHeight);
+
+					capture.open("capture.y4m", VideoFormat_Y4M, captureWidth, captureHeight, App.captureFps);
+				}
+				ImGui::SetItemTooltip("The simulation runs at the capture rate while recording, so the video plays back at real speed");
+			}
+
+			ImGui::SliderInt("Capture rate (fps)", &App.captureFps, 10, 120);
+
+			ImGui::SeparatorText("Simulation");
+
+			if (ImGui::SliderFloat("Rate (Hz)", &App.simRate, 10.0f, 480.0f, "%.0f"))
+				simClock.setRate(App.simRate);
+
+			ImGui::SetItemTooltip("Fixed steps per second, rendering interpolates between the last two");
+
+			ImGui::SliderInt("Max steps per frame", &simClock.maxSteps, 1, 32);
+			ImGui::SetItemTooltip("Time beyond this is dropped after a hitch instead of being caught up");
+
+			ImGui::Text("Steps: %llu | Dropped: %llu", (unsigned long long)simClock.totalSteps, (unsigned long long)simClock.droppedSteps);
+
+			ImGui::SeparatorText("GL state cache");
+
+			if (ImGui::BeginTable("GL state cache", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+			{
+				ImGui::TableSetupColumn("Call");
+				ImGui::TableSetupColumn("Issued");
+				ImGui::TableSetupColumn("Skipped");
+				ImGui::TableHeadersRow();
+
+				for (int i = 0; i < GLStat_COUNT; i++)
+				{
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(getGLStatName((GLStat)i));
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", GLState.lastFrame.issued[i]);
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", GLState.lastFrame.skipped[i]);
+				}
+
+				ImGui::EndTable();
+			}
+			ImGui::SetItemTooltip("GL calls of the last frame, skipped ones would not have changed any state");
+
+			ImGui::Text("Scene draw calls: %u | Uploaded: %.1f KB", GLState.lastFrame.drawCalls, GLState.lastFrame.uploadBytes / 1024.0f);
+
+			ImGui::Text("Heap allocations: %u | Frees: %u | %.1f KB", Allocs.lastFrame.allocs, Allocs.lastFrame.frees, Allocs.lastFrame.bytes / 1024.0f);
+			ImGui::SetItemTooltip("operator new and ImGui allocations of the last frame, from every thread. Should stay at zero once warmed up.");
+
+			int uiCommands = 0, uiDraws = 0;
+			ImGui_ImplOpenGL3_GetLastFrameStats(&uiCommands, &uiDraws);
+			ImGui::Text("UI commands: %d | UI draw calls: %d", uiCommands, uiDraws);
+
+			if (ImGui::Checkbox("Batch UI draws", &App.uiMultiDraw))
+				ImGui_ImplOpenGL3_SetMultiDrawIndirect(App.uiMultiDraw);
+
+			if (ImGui_ImplOpenGL3_IsMultiDrawIndirectSupported())
+				ImGui::SetItemTooltip("One glMultiDrawElementsIndirect per run of commands with the same texture, clipped in the shader");
+			else
+				ImGui::SetItemTooltip("Needs GL 4.3 or ARB_multi_draw_indirect, this driver draws every command on its own");
+
+			const StreamBuffer &instanceStream = swarm.getInstanceStream();
+			ImGui::Text("Instance stream: %s, %.0f KB per frame | Stalls: %u", instanceStream.isPersistent() ? "mapped" : "orphaned",
+				instanceStream.getRegionSize() / 1024.0f, instanceStream.stalls);
+			ImGui::SetItemTooltip("Stalls are frames that waited for the GPU to finish reading the region three frames back");
+
+			ImGui::SeparatorText("Texture cache");
 
-			ImGui::ColorPicker4("Background Color", (float *)&App.backgroundColor);
+			ImGui::Text("Textures: %d | Resident: %.1f MB", textureManager.getTextureCount(), textureManager.getResidentBytes() / (1024.0f * 1024.0f));
+			ImGui::Text("Hits: %u | Misses: %u", textureManager.hits, textureManager.misses);
+
+			int budgetMB = (int)(textureManager.vramBudget >> 20);
+			if (ImGui::SliderInt("VRAM budget (MB)", &budgetMB, 16, 4096))
+				textureManager.vramBudget = (size_t)budgetMB << 20;
+
+			ImGui::SetItemTooltip("Unused textures are evicted, least recently used first, once the cache grows past this");
+
+			ImGui::SeparatorText("Font atlas");
+
+			const ImFontAtlasBuildTimings &fontTimings = fonts->BuildTimings;
+			ImGui::Text("Glyphs: %d | %dx%d | Built in %.2f ms", fontTimings.GlyphCount, fonts->TexWidth, fonts->TexHeight, fontTimings.Total);
+			ImGui::Text("Gather %.2f | Pack %.2f | Rasterize %.2f | Setup %.2f ms", fontTimings.Gather, fontTimings.Pack, fontTimings.Rasterize, fontTimings.Setup);
+			ImGui::Text("Rasterized in %d tasks%s", fontTimings.RasterTasks, fontTimings.Parallel ? " on the job system" : "");
+
+			ImGui::SeparatorText("Program cache");
+
+			ImGui::Text("Loaded from disk: %u | Compiled: %u", Programs.binaryLoads, Programs.sourceCompiles);
+			if (!GLExt.programBinary)
+				ImGui::TextDisabled("Program binaries not supported by this driver");
 
 			ImGui::End();
 		}
@@ -534,7 +781,15 @@ int main()
 				colorPickerFlag |= ImGuiColorEditFlags_NoSidePreview;
 				colorPickerFlag |= ImGuiColorEditFlags_NoSmallPreview;
 
-				ImGui::ColorPicker4("Box Color", (float *)&box.color, colorPickerFlag);
+				uint64_t colorSectionHash = hashBytes(&box.color, sizeof(box.color));
+				colorSectionHash = hashBytes(&colorPickerFlag, sizeof(colorPickerFlag), colorSectionHash);
+
+				if (ImGui::BeginRetained("Color", (ImGuiID)colorSectionHash))
+				{
+					ImGui::ColorPicker4("Box Color", (float *)&box.color, colorPickerFlag);
+
+					ImGui::EndRetained();
+				}
 
 				ImGui::SeparatorText("Texture");
 
@@ -545,9 +800,17 @@ int main()
 				}
 
 				ImGui::BeginGroup();
+				if (App.pendingTexture)
+				{
+					ImGui::Text("Loading...");
+					ImGui::ProgressBar(textureManager.getProgress(App.pendingTexture), ImVec2(120, 0));
+				}
+				else
 				{
 					if (ImGui::Button((box.hasTexture()) ? "Change" : "Add"))
 					{
+						App.textureForSwarm = false;
+
 						std::thread tr(changeTexture_concurrent);
 						tr.detach();
 					}
@@ -568,12 +831,56 @@ int main()
 			{
 				ImGui::Text("X:\t%.2f | Y:\t%.2f", box.pos.x, box.pos.y);
 
+				ImGui::Checkbox("Visible", &App.showBox);
+				ImGui::SameLine();
+				ImGui::Checkbox("Moving", &App.boxMoving);
+				ImGui::SetItemTooltip("A stopped box still follows the arrow keys");
+
 				if (ImGui::Button("Reset"))
 				{
+					boxSim.teleport(0, 0.0f, 0.0f);
 					box.pos = glm::vec3(0.0f);
 				}
 			}
 
+			if (ImGui::CollapsingHeader("Swarm"))
+			{
+				if (ImGui::SliderInt("Count", &App.swarmCount, 0, 100000, "%d", ImGuiSliderFlags_Logarithmic))
+					swarm.resize(App.swarmCount);
+
+				ImGui::SetItemTooltip("Number of boxes drawn with a single instanced draw call");
+
+				if (ImGui::SliderFloat("Box size", &App.swarmBoxSize, 0.001f, 0.1f, "%.3f", ImGuiSliderFlags_Logarithmic))
+					swarm.setBoxSize(App.swarmBoxSize);
+
+				if (ImGui::Checkbox("Collisions", &App.swarmCollisions))
+					swarm.setCollisions(App.swarmCollisions);
+
+				ImGui::SetItemTooltip("Boxes bounce off each other, found through a uniform grid rebuilt every step");
+
+				if (App.swarmCollisions)
+					ImGui::Text("Pairs tested: %u | Contacts: %u", swarm.pairsTested, swarm.contacts);
+
+				ImGui::Text("Logos: %d", logoAtlas.getLayerCount());
+				ImGui::SameLine();
+
+				if (App.pendingLogo)
+				{
+					ImGui::ProgressBar(textureManager.getProgress(App.pendingLogo), ImVec2(120, 0));
+				}
+				else if (ImGui::Button("Add logo"))
+				{
+					App.textureForSwarm = true;
+
+					std::thread tr(changeTexture_concurrent);
+					tr.detach();
+				}
+				ImGui::SetItemTooltip("Add an image to the swarm's texture array, boxes cycle through all of them");
+
+				ImGui::Text("Simulation kernel: %s", getSimKernelName(getSimKernel()));
+				ImGui::Text("Worker threads: %d", jobs.getWorkerCount());
+			}
+
 			ImGui::End();
 		}
 
@@ -596,13 +903,20 @@ int main()
 
 				if (ImGui::Button("OK", ImVec2(120, 0)))
 				{
-					box.createTexture(
-						App.filePath.c_str(),
-						wrapper[wrapperCurrent],
-						wrapper[wrapperCurrent],
-						filters[filterCurrent],
-						filters[filterCurrent],
-						fmts[formatCurrent]);
+					TextureParams params;
+					params.wrapS = wrapper[wrapperCurrent];
+					params.wrapT = wrapper[wrapperCurrent];
+					params.filterMin = filters[filterCurrent];
+					params.filterMag = filters[filterCurrent];
+					params.format = fmts[formatCurrent];
+
+					// The box keeps its current texture until the new one is fully uploaded
+					int request = textureManager.acquire(App.filePath.c_str(), params);
+
+					if (App.textureForSwarm)
+						App.pendingLogo = request;
+					else
+						App.pendingTexture = request;
 					App.showTextureModalChange = false;
 					App.filePath.clear();
 				}
@@ -628,7 +942,8 @@ int main()
 
 				if (ImGui::Button("OK", ImVec2(120, 0)))
 				{
-					box.deleteTexture();
+					textureManager.release(box.getTexture());
+					box.setTexture(0, 0, 0);
 					App.showTextureModalDelete = false;
 				}
 
@@ -643,63 +958,179 @@ int main()
 			}
 		}
 
+		Profile.popZone();
+
 		// Update projection
 		//App.proj = glm::ortho(0.0f, (float)App.width, 0.0f, (float)App.height, 0.1f, 100.0f);
 		//App.proj = glm::perspective(glm::radians(75.0f), (float)(App.width / App.height), 0.1f, 100.0f);
 
-		// Reset the box if it goes outside the frame
-		if (
-			box.pos.x >  1.0f ||
-			box.pos.x < -1.0f ||
-			box.pos.y >  1.0f ||
-			box.pos.y < -1.0f
-		) {
-			box.pos = glm::vec3(0.0f);
+		// Upload part of any pending texture, then swap it in once it is complete
+		Profile.pushZone("Texture upload", true);
+		textureManager.update();
+
+		if (App.pendingTexture)
+		{
+			GLuint texture;
+			int txWidth, txHeight;
+
+			TextureLoadResult result = textureManager.poll(App.pendingTexture, texture, txWidth, txHeight);
+			if (result == TextureLoad_Ready)
+			{
+				GLuint oldTexture = box.getTexture();
+
+				box.setTexture(texture, txWidth, txHeight);
+
+				if (oldTexture)
+					textureManager.release(oldTexture);
+			}
+
+			if (result != TextureLoad_Pending)
+				App.pendingTexture = 0;
 		}
 
-		// Draw box
-		static glm::vec3 direction(0.5f, 0.5f, 0.0f);
+		if (App.pendingLogo)
+		{
+			GLuint texture;
+			int txWidth, txHeight;
 
-		if (box.pos.x > 0.8f)
-			direction.x *= -1.0f;
+			TextureLoadResult result = textureManager.poll(App.pendingLogo, texture, txWidth, txHeight);
+			if (result == TextureLoad_Ready)
+			{
+				// The atlas keeps its own copy
+				logoAtlas.addLayer(texture, txWidth, txHeight);
+				textureManager.release(texture);
 
-		if (box.pos.x < -0.8f)
-			direction.x *= -1.0f;
+				swarm.setLayerCount(logoAtlas.getLayerCount());
+			}
 
-		if (box.pos.y > 0.75f)
-			direction.y *= -1.0f;
+			if (result != TextureLoad_Pending)
+				App.pendingLogo = 0;
+		}
 
-		if (box.pos.y < -0.8f)
-			direction.y *= -1.0f;
+		Profile.popZone();
 
-		box.pos += direction * boxSpeed;
-		box.model = glm::translate(box.model, box.pos);
+		ImGui::Render();
+		ImDrawData *drawData = ImGui::GetDrawData();
 
-		box.draw();
+		// Compare what this frame would show with the last one, everything moving on its own counts as a change
+		if (App.skipIdleFrames && !App.headless)
+		{
+			uint64_t frameHash = hashDrawData(drawData, hashBytes(&App.backgroundColor, sizeof(App.backgroundColor)));
+			frameHash = hashBytes(&App.showBox, sizeof(App.showBox), frameHash);
 
-		glUniformMatrix4fv(
-			glGetUniformLocation(box.getProgramID(), "uModel"),
-			1,
-			GL_FALSE,
-			glm::value_ptr(box.model)
+			// A hidden box can keep moving, only what is drawn matters
+			if (App.showBox)
+			{
+				GLuint boxTexture = box.getTexture();
+
+				frameHash = hashBytes(&box.pos, sizeof(box.pos), frameHash);
+				frameHash = hashBytes(&box.color, sizeof(box.color), frameHash);
+				frameHash = hashBytes(&boxTexture, sizeof(boxTexture), frameHash);
+			}
+
+			bool animating = swarm.getCount() > 0 || App.pendingTexture || App.pendingLogo || capture.isOpen();
+			bool idle = !animating && !App.forceRedraw && frameHash == lastFrameHash;
+
+			lastFrameHash = frameHash;
+			App.forceRedraw = false;
+
+			if (idle)
+			{
+				App.skippedFrames++;
+				frameSkipped = true;
+
+				Profile.pushZone("Idle wait");
+				glfwWaitEventsTimeout(IDLE_WAIT_TIMEOUT);
+				Profile.popZone();
+
+				continue;
+			}
+		}
+
+		frameSkipped = false;
+		App.shownSkippedFrames = App.skippedFrames;
+
+		glClearColor(
+			App.backgroundColor.x,
+			App.backgroundColor.y,
+			App.backgroundColor.z,
+			App.backgroundColor.w
 		);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// Draw swarm
+		Profile.pushZone("Swarm draw", true);
+		swarm.upload();
+		swarm.draw(logoAtlas);
+		Profile.popZone();
+
+		// Draw box
+		Profile.pushZone("Box draw", true);
+
+		if (App.showBox)
+		{
+			box.model = glm::translate(box.model, box.pos);
+			box.setUniform(Uniform_Model, box.model);
+
+			box.draw();
+		}
 
 		// Reset to matrix identity
 		box.model = glm::mat4(1.0f);
 
-		ImGui::Render();
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		Profile.popZone();
+
+		Profile.pushZone("ImGui render", true);
+		ImGui_ImplOpenGL3_RenderDrawData(drawData);
+		Profile.popZone();
+
+		// Reads the offscreen target in headless mode and the back buffer otherwise
+		if (capture.isOpen())
+		{
+			Profile.pushZone("Capture");
+			capture.capture();
+			Profile.popZone();
 
+			if (capture.hasFailed())
+			{
+				fprintf(stderr, "Video capture failed, stopping it\n");
+				capture.close();
+			}
+		}
+
+		Profile.pushZone("Swap");
 		glfwSwapBuffers(window);
+		Profile.popZone();
+
+		Profile.pushZone("Input");
 		glfwPollEvents();
+		Profile.popZone();
 	}
 
-	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
-	ImGui::DestroyContext();
+	// Write out the frames still in flight
+	capture.close();
 
-	glfwDestroyWindow(window);
-	glfwTerminate();
+	if (App.headless)
+	{
+		// Wait for the GPU so the time covers every frame actually rendered
+		glFinish();
+
+		double elapsed = glfwGetTime() - startTime;
+
+		// Keep the summary out of a video going to stdout
+		bool videoOnStdout = App.capturePath && strcmp(App.capturePath, "-") == 0;
+		fprintf(videoOnStdout ? stderr : stdout, "Rendered %d frames in %.3f s, %.3f ms per frame\n", frame, elapsed, elapsed * 1000.0 / frame);
+	}
+
+	if (App.allocCheckFrame >= 0)
+	{
+		if (App.allocCheckFailures > 0)
+			fprintf(stderr, "Allocation check failed: %d frames after frame %d used the heap\n", App.allocCheckFailures, App.allocCheckFrame);
+		else
+			fprintf(stderr, "Allocation check passed: no heap use after frame %d\n", App.allocCheckFrame);
+	}
 
-	return 0;
+	// The job system goes away with this scope
+	fonts->ParallelFor = NULL;
+	fonts->ParallelForUserData = NULL;
 }
\ No newline at end of file